@@ -11,9 +11,7 @@ BuildRequires:  cmake
 BuildRequires:	gcc
 BuildRequires:	g++
 BuildRequires:	libpng-devel
-BuildRequires:	tinyxml2-devel
 Requires:       libpng
-Requires:	tinyxml2
 Requires:	glibc
 
 %description
@@ -0,0 +1,58 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "BinaryCursor.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// BIGFILE.DAT is the archive that every DRM and VRM in the game is stored in
+// It starts with a directory: a 32-bit entry count followed by one 16 byte entry per file
+// Files are only identified by a hash of their original path, the archive does not store any names
+
+struct BigfileEntry
+{
+	unsigned int fileHash;
+	unsigned int fileLength;
+	unsigned int fileOffset;
+	unsigned int checksum;
+};
+
+struct BigfileIndex
+{
+	std::vector<BigfileEntry> entries;
+	std::unordered_map<unsigned int, unsigned int> entryIDsByHash;
+};
+
+// A DRM and the VRM that holds its textures, both given by their hashes
+struct BigfilePair
+{
+	unsigned int drmHash;
+	unsigned int vrmHash;
+};
+
+int readBigfileIndex(BinaryCursor reader, BigfileIndex& index);
+
+const BigfileEntry* findBigfileEntry(const BigfileIndex& index, unsigned int fileHash);
+
+BinaryCursor getBigfileEntryData(BinaryCursor reader, const BigfileEntry& entry);
+
+bool parseBigfilePair(std::string argument, BigfilePair& pair);
+
+void listBigfileEntries(const BigfileIndex& index);
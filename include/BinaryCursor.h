@@ -0,0 +1,85 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+// Little-endian reader over a block of memory that is already loaded (e.g. a mapped DRM)
+// Reading past the end throws std::out_of_range, which the callers treat the same as the end of a stream
+// Copying a cursor is cheap, so readers are handed their own cursor positioned at the record they should read
+class BinaryCursor
+{
+public:
+	BinaryCursor() = default;
+	BinaryCursor(const unsigned char* data, size_t size, size_t start = 0)
+		: base(data), length(size), position(start) {}
+
+	template<typename T>
+	T read()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "BinaryCursor can only read trivially copyable types");
+
+		if (position > length || length - position < sizeof(T))
+			throw std::out_of_range("BinaryCursor read past the end of its data");
+
+		T value;
+		std::memcpy(&value, base + position, sizeof(T));
+		position += sizeof(T);
+
+		if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1)
+		{
+			unsigned char bytes[sizeof(T)];
+			std::memcpy(bytes, &value, sizeof(T));
+			for (size_t i = 0; i < sizeof(T) / 2; i++)
+			{
+				unsigned char swap = bytes[i];
+				bytes[i] = bytes[sizeof(T) - 1 - i];
+				bytes[sizeof(T) - 1 - i] = swap;
+			}
+			std::memcpy(&value, bytes, sizeof(T));
+		}
+
+		return value;
+	}
+
+	// New cursor over the same data, positioned at an absolute offset
+	BinaryCursor at(size_t offset) const { return BinaryCursor(base, length, offset); }
+
+	// New cursor whose offset 0 is at the given offset of this one, limited to the given length
+	BinaryCursor subspan(size_t offset, size_t count) const
+	{
+		if (offset > length || length - offset < count)
+			throw std::out_of_range("BinaryCursor subspan is outside of its data");
+
+		return BinaryCursor(base + offset, count);
+	}
+
+	void seek(size_t offset) { position = offset; }
+	void skip(size_t count) { position += count; }
+	size_t tell() const { return position; }
+
+	const unsigned char* data() const { return base; }
+	size_t size() const { return length; }
+
+private:
+	const unsigned char* base = nullptr;
+	size_t length = 0;
+	size_t position = 0;
+};
@@ -0,0 +1,87 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// A text file written through a buffer, which is written out whenever it fills up, for the exporters that write their files as they go
+class BufferedFile
+{
+public:
+	BufferedFile() = default;
+	BufferedFile(const BufferedFile&) = delete;
+	BufferedFile& operator=(const BufferedFile&) = delete;
+	~BufferedFile();
+
+	// Returns false if the file couldn't be created
+	bool open(std::string path);
+
+	// Writes what is left in the buffer and closes the file
+	// Returns false if any of the file couldn't be written
+	bool close();
+
+	void write(std::string_view text)
+	{
+		buffer += text;
+		flushIfFull();
+	}
+
+	void write(char character)
+	{
+		buffer += character;
+		flushIfFull();
+	}
+
+	void write(size_t count, char character)
+	{
+		buffer.append(count, character);
+		flushIfFull();
+	}
+
+	// Makes room for up to maxLength characters to be written straight into
+	// endInPlace is then given one past the last character that was written
+	char* beginInPlace(size_t maxLength)
+	{
+		size_t start = buffer.size();
+		buffer.resize(start + maxLength);
+		return buffer.data() + start;
+	}
+
+	void endInPlace(char* end)
+	{
+		buffer.resize(end - buffer.data());
+		flushIfFull();
+	}
+
+private:
+	// The buffer is written out once it gets past this size
+	static constexpr size_t bufferSize = 64 * 1024;
+
+	void flushIfFull()
+	{
+		if (buffer.size() >= bufferSize)
+			flush();
+	}
+
+	void flush();
+
+	FILE* file = nullptr;
+	std::string buffer;
+	bool writeFailed = false;
+};
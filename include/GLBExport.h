@@ -0,0 +1,28 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ModelStructs.h"
+
+#include <string>
+#include <vector>
+
+// Writes the model as a binary glTF 2.0 file, "object.glb", with one primitive per material
+// Each primitive has its own indexed vertices, with a vertex for each distinct position and UV its corners use
+// The materials' textures are embedded in the file, so texture embedding has to be on while they are exported
+// Returns 0 on success, 1 if some materials didn't export properly, and 2 if the file couldn't be written, the same as exportToXML
+int exportToGLB(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials);
@@ -0,0 +1,99 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ScratchArena.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// A decoded texture, ready to be encoded to an image file
+struct TextureImage
+{
+	unsigned int width;
+	unsigned int height;
+
+	// 4 or 8 for palette images, where the texels are indices into the palette
+	// 0 for direct colour images, where the texels are PS1 15-bit colours and there is no palette
+	unsigned int bitDepth;
+
+	// Row y of the texture starts at texels[y * texelStride]
+	const unsigned short int* texels;
+	size_t texelStride;
+
+	// RGBA8 pixels, 4 bytes each in the order red, green, blue, alpha
+	const unsigned int* palette;
+	unsigned int paletteSize;
+};
+
+// Converts one row of a texture to RGBA8 pixels
+void expandTextureRow(const TextureImage& image, unsigned int y, unsigned int* RGBA);
+
+// Converts a texture to PS1 15-bit colours, width * height of them with no gap between rows
+// Used where textures with different palettes end up in the same image
+void textureImageToColours(const TextureImage& image, unsigned short int* colours);
+
+// Encodes textures to one image file format
+// Encoding is done into memory, scratch memory comes from the arena given
+class ImageSink
+{
+public:
+	virtual ~ImageSink() = default;
+
+	// File extension, without the dot
+	virtual const char* extension() const = 0;
+
+	virtual bool encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded) = 0;
+};
+
+// PNG through libpng; palette textures are written as palette images at their own bit depth
+// The zlib compression level (0-9) and the filters are left to libpng's defaults when they are -1
+class PNGImageSink : public ImageSink
+{
+public:
+	PNGImageSink(int compressionLevel = -1, int filters = -1) : compressionLevel(compressionLevel), filters(filters) {}
+
+	const char* extension() const override { return "png"; }
+	bool encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded) override;
+
+private:
+	int compressionLevel;
+	int filters;
+};
+
+// Uncompressed 32-bit TGA
+class TGAImageSink : public ImageSink
+{
+public:
+	const char* extension() const override { return "tga"; }
+	bool encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded) override;
+};
+
+// QOI (Quite OK Image format), lossless and much faster to encode than PNG
+class QOIImageSink : public ImageSink
+{
+public:
+	const char* extension() const override { return "qoi"; }
+	bool encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded) override;
+};
+
+// Parses a PNG filter name (none, sub, up, avg, paeth or all) into libpng's filter flags, -1 if it isn't one
+int parsePNGFilter(std::string filterName);
+
+// Makes the image sink for a format name (png, tga or qoi), nullptr if it isn't one
+std::unique_ptr<ImageSink> createImageSink(std::string format, int pngCompressionLevel, int pngFilters);
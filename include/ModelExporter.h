@@ -16,11 +16,29 @@
 
 #pragma once
 
+#include "BinaryCursor.h"
+#include "Bigfile.h"
+
 #include <string>
+#include <vector>
+
+// File format the models are written in
+enum class ModelFormat
+{
+	DAE,
+	GLB,
+	OBJ
+};
+
+int readFile(std::string inputFile, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully);
+
+int readBigfile(std::string inputFile, std::vector<BigfilePair>& bigfilePairs, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully);
 
-int readFile(std::ifstream& reader, std::string inputFile, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+int readDRM(BinaryCursor drmReader, std::string drmName, std::string outputFolder, int selectedModelExport, bool listNamesBool,
 	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully);
 
-int convertObjToDAE(std::ifstream& reader, std::string outputFolder, std::string objectName, std::string inputFile);
+int convertObjToDAE(BinaryCursor reader, std::string outputFolder, std::string objectName);
 
-int convertLevelToDAE(std::ifstream& reader, std::string outputFolder, std::string inputFile);
\ No newline at end of file
+int convertLevelToDAE(BinaryCursor reader, std::string outputFolder, std::string objectName);
\ No newline at end of file
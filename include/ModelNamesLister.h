@@ -16,6 +16,6 @@
 
 #pragma once
 
-#include <iostream>
+#include "BinaryCursor.h"
 
-int listNames(std::ifstream& reader, unsigned int modelsAddressesStart);
\ No newline at end of file
+int listNames(BinaryCursor reader, unsigned int modelsAddressesStart);
\ No newline at end of file
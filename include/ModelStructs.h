@@ -42,20 +42,22 @@ struct UV
 {
 	float u, v;
 };
-inline bool sortUCoord(const UV &a, const UV &b)
-{
-	return a.u < b.u;
-}
-inline bool sortVCoord(const UV &a, const UV &b)
-{
-	return a.v < b.v;
-}
 
 struct PolygonStruct
 {
-	Vertex v1, v2, v3;
+	// Indices into the mesh's shared vertices
+	unsigned short int v1, v2, v3;
 	unsigned int materialID;
-	UV uv1, uv2, uv3;
+};
+
+// Indexed mesh of a single model
+// Polygons only hold indices of their vertices, and the UVs of their corners are packed into one array
+// Corner c of polygon p has its UV at UVs[(p * 3) + c]
+struct Mesh
+{
+	std::vector<Vertex> vertices;
+	std::vector<PolygonStruct> polygons;
+	std::vector<UV> UVs;
 };
 
 struct ObjectAnimationSubframe
@@ -79,4 +81,8 @@ struct Material
 	unsigned short int texturePage;
 	unsigned int textureID;
 	std::vector<ObjectAnimationSubframe> objectSubframes;
+
+	// Once the polygons have been grouped by material, this material's polygons are polygons[polygonStart] to polygons[polygonStart + polygonCount - 1]
+	unsigned int polygonStart;
+	unsigned int polygonCount;
 };
\ No newline at end of file
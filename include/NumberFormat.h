@@ -0,0 +1,43 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <cstddef>
+
+// Number formatting for the exported files, written straight into a buffer given by the caller with no allocation
+// Each function returns one past the last character it wrote, and never writes more than maxFormattedNumberLength characters
+
+constexpr size_t maxFormattedNumberLength = 32;
+
+// number / 10^powerOfTen (powerOfTen up to 9) with the fraction's trailing zeros removed, unless the fraction is all zeros
+// e.g. 1250 -> "1.25", -5 -> "-0.005", 2000 -> "2.000", and with powerOfTen 0 just the integer
+char* formatFixedPoint(char* buffer, int number, unsigned int powerOfTen);
+
+// Just the integer, for indices and counts
+char* formatInteger(char* buffer, long long int number);
+
+// The shortest text that reads back as the same float, the same as std::format("{}", value)
+char* formatFloat(char* buffer, float value);
+
+// 6 decimal places, the same as std::to_string(value), for values under 10^24
+char* formatFloatFixed(char* buffer, float value);
+
+// Batch versions, which write each value followed by a space
+// The buffer must have room for count * (maxFormattedNumberLength + 1) characters
+char* formatFixedPoints(char* buffer, const int* numbers, size_t count, unsigned int powerOfTen);
+char* formatIntegers(char* buffer, const int* numbers, size_t count);
+char* formatFloats(char* buffer, const float* values, size_t count);
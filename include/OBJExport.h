@@ -0,0 +1,27 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ModelStructs.h"
+
+#include <string>
+#include <vector>
+
+// Writes the model as Wavefront OBJ, "object.obj", with its materials in "object.mtl"
+// The lines are written out as they are made, the model's vertices and distinct UVs are each written once and shared by the faces
+// Returns 0 on success, 1 if some materials didn't export properly, and 2 if the files couldn't be written, the same as exportToXML
+int exportToOBJ(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials);
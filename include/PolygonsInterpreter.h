@@ -18,33 +18,56 @@
 
 #include "ModelStructs.h"
 #include "TextureStructs.h"
+#include "BinaryCursor.h"
 
-#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// Hash lookups used while reading polygons, so that finding a polygon's material does not mean searching through every material
+struct MaterialLookup
+{
+	// Real materials, keyed by (texturePage << 16) | clutValue
+	std::unordered_map<unsigned int, unsigned int> realMaterialIDs;
+
+	// "Fake materials", keyed by (red << 16) | (green << 8) | blue
+	std::unordered_map<unsigned int, unsigned int> fakeMaterialIDs;
+
+	// Number of real materials so far, which is also the texture ID of the next one
+	unsigned int textureCount = 0;
+
+	// Object animation subframes, in the order they were read
+	// Keyed by the address of the material they animate, and by (texturePage << 16) | clutValue
+	std::unordered_map<unsigned int, std::vector<unsigned int>> subframeIDsByMaterialAddress;
+	std::unordered_map<unsigned int, std::vector<unsigned int>> subframeIDsByClutAndPage;
+};
 #include <vector>
 
-void readPolygons(std::ifstream& reader, std::string objectName, std::string outputFolder, unsigned short int polygonCount,
-    unsigned int polygonStartAddress, unsigned int textureAnimationsStartAddress, bool isObject, std::vector<PolygonStruct>& polygons,
-    std::vector<Material>& materials, std::vector<Vertex>& vertices);
+void readPolygons(BinaryCursor reader, std::string objectName, std::string outputFolder, unsigned short int polygonCount,
+    unsigned int polygonStartAddress, unsigned int textureAnimationsStartAddress, bool isObject, Mesh& modelMesh,
+    std::vector<Material>& materials);
+
+void groupPolygonsByMaterial(Mesh& modelMesh, std::vector<Material>& materials);
 
-PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialStartAddress, bool isObject,
-    std::vector<Material>& materials, std::vector<Vertex>& vertices, std::vector<ObjectAnimationSubframe>& subframes);
+PolygonStruct readPolygon(BinaryCursor reader, unsigned int p, int materialStartAddress, bool isObject, UV* polygonUVs,
+    std::vector<Material>& materials, MaterialLookup& materialLookup, std::vector<Vertex>& vertices, std::vector<ObjectAnimationSubframe>& subframes);
 
-void readObjectPolygon(std::ifstream& reader, PolygonStruct& thisPolygon, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress);
+void readObjectPolygon(BinaryCursor& reader, UV* polygonUVs, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress);
 
-void readLevelPolygon(std::ifstream& reader, PolygonStruct& thisPolygon, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress);
+void readLevelPolygon(BinaryCursor& reader, UV* polygonUVs, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress);
 
-Material readMaterial(std::ifstream& reader);
+Material readMaterial(BinaryCursor reader);
 
-std::vector<ObjectAnimationSubframe> readObjectAnimationSubFrames(std::ifstream& reader, unsigned int textureAnimationsStartAddress);
+std::vector<ObjectAnimationSubframe> readObjectAnimationSubFrames(BinaryCursor reader, unsigned int textureAnimationsStartAddress);
 
-ObjectAnimationSubframe readObjectAnimationSubFrame(std::ifstream& reader, unsigned int baseMaterialAddress);
+ObjectAnimationSubframe readObjectAnimationSubFrame(BinaryCursor reader, unsigned int baseMaterialAddress);
 
-std::vector<LevelAnimationSubframe> readLevelAnimationSubFrames(std::ifstream& reader, unsigned int textureAnimationsStartAddress);
+std::vector<LevelAnimationSubframe> readLevelAnimationSubFrames(BinaryCursor reader, unsigned int textureAnimationsStartAddress);
 
-LevelAnimationSubframe* readLevelAnimationSubFrame(std::ifstream& reader, unsigned int baseMaterialAddress);
+// Level animations come in pairs of subframes, both are appended to levelSubframes
+void readLevelAnimationSubFrame(BinaryCursor reader, unsigned int baseMaterialAddress, std::vector<LevelAnimationSubframe>& levelSubframes);
 
 bool UVPointCorrectionAndExport(unsigned int materialID, bool isObject, std::string objectName, std::string outputFolder, Material thisMaterial,
-    std::vector<PolygonStruct>& polygons, bool exportLevelAnimations, std::vector<LevelAnimationSubframe>& levelSubframes);
+    Mesh& modelMesh, bool exportLevelAnimations, std::vector<LevelAnimationSubframe>& levelSubframes);
 
 bool objectSubframePointCorrectionAndExport(unsigned int materialID, unsigned int textureID, std::string objectName,
     std::string outputFolder, ObjectAnimationSubframe subframe);
\ No newline at end of file
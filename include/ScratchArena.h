@@ -0,0 +1,106 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for scratch memory that only lives while one model is being exported
+// Memory is handed out from large blocks and is never freed individually; reset() makes all of it reusable again
+// The blocks are kept between resets, so once they have grown to fit the biggest texture nothing more is allocated
+class ScratchArena
+{
+public:
+	explicit ScratchArena(size_t blockSize = 1024 * 1024) : defaultBlockSize(blockSize) {}
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	// Uninitialised space for count objects of type T
+	template<typename T>
+	T* allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "ScratchArena never runs destructors");
+
+		return static_cast<T*>(allocateBytes(count * sizeof(T), alignof(T)));
+	}
+
+	// Position in the arena, so that everything allocated after it can be given back with rewind()
+	struct Marker
+	{
+		size_t block;
+		size_t offset;
+	};
+
+	Marker mark() const { return { currentBlock, currentOffset }; }
+	void rewind(Marker marker) { currentBlock = marker.block; currentOffset = marker.offset; }
+
+	void reset() { rewind({ 0, 0 }); }
+
+	// Gives back everything allocated during its lifetime when it goes out of scope
+	class Scope
+	{
+	public:
+		explicit Scope(ScratchArena& scopeArena) : arena(scopeArena), marker(scopeArena.mark()) {}
+		~Scope() { arena.rewind(marker); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ScratchArena& arena;
+		Marker marker;
+	};
+
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		size_t size;
+	};
+
+	void* allocateBytes(size_t byteCount, size_t alignment)
+	{
+		while (currentBlock < blocks.size())
+		{
+			size_t alignedOffset = (currentOffset + alignment - 1) & ~(alignment - 1);
+			if (alignedOffset <= blocks[currentBlock].size && blocks[currentBlock].size - alignedOffset >= byteCount)
+			{
+				currentOffset = alignedOffset + byteCount;
+				return blocks[currentBlock].data.get() + alignedOffset;
+			}
+
+			// Doesn't fit in what's left of this block, move on to the next one
+			currentBlock++;
+			currentOffset = 0;
+		}
+
+		// Blocks come from new[], so they are aligned for any fundamental type
+		size_t blockSize = byteCount > defaultBlockSize ? byteCount : defaultBlockSize;
+		blocks.push_back({ std::make_unique<unsigned char[]>(blockSize), blockSize });
+		currentBlock = blocks.size() - 1;
+		currentOffset = byteCount;
+		return blocks[currentBlock].data.get();
+	}
+
+	std::vector<Block> blocks;
+	size_t defaultBlockSize;
+	size_t currentBlock = 0;
+	size_t currentOffset = 0;
+};
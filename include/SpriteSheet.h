@@ -0,0 +1,35 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ImageSink.h"
+
+#include <string>
+
+// Sprite sheet mode writes the animation frames of a texture as a grid in one image, instead of one image per frame
+// Frames that are identical to an earlier frame are only stored once
+// A text file alongside the sheet lists where each frame is in it
+
+void setSpriteSheetsEnabled(bool enabled);
+bool spriteSheetsEnabled();
+
+// Keeps a copy of an animation frame of a texture, replacing any frame already added with the same number
+void addSpriteSheetFrame(unsigned int textureIndex, unsigned int frame, const TextureImage& image);
+
+// Writes the frames added for a texture as "object-texN-frames", along with "object-texN-frames.txt", and forgets them
+// Does nothing if the texture has no frames, returns false if either file couldn't be written
+bool exportSpriteSheet(std::string objectName, std::string outputFolder, unsigned int textureIndex);
@@ -0,0 +1,43 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ModelStructs.h"
+#include "ImageSink.h"
+
+#include <string>
+#include <vector>
+
+// Texture atlas mode packs the textures of all of a model's real materials into one image, rather than one image per material
+// Animation subframe textures are still written as their own images
+
+void setTextureAtlasEnabled(bool enabled);
+bool textureAtlasEnabled();
+
+// File name of a model's atlas, e.g. "object-atlas.png"
+std::string textureAtlasFileName(std::string objectName);
+
+// Forgets the textures added so far, for starting a new model
+void clearTextureAtlas();
+
+// Keeps a copy of a material's texture to be packed into the atlas
+void addTextureToAtlas(unsigned int materialID, const TextureImage& image);
+
+// Packs the textures added since the atlas was last cleared into a power of two image and writes it
+// The UVs of each material's polygons are moved from its own texture to its place in the atlas
+// Returns false if the atlas couldn't be written
+bool exportTextureAtlas(std::string objectName, std::string outputFolder, Mesh& modelMesh, std::vector<Material>& materials);
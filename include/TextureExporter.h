@@ -17,8 +17,10 @@
 #pragma once
 
 #include "TextureStructs.h"
+#include "ImageSink.h"
 
 #include <string>
+#include <vector>
 
 int goToTexPageAndApplyCLUT(unsigned short int texturePage, unsigned short int clutValue, unsigned int left, unsigned int right,
     unsigned int south, unsigned int north, std::string objectName, std::string outputFolder, unsigned int textureIndex,
@@ -26,7 +28,51 @@ int goToTexPageAndApplyCLUT(unsigned short int texturePage, unsigned short int c
 
 bool resetModifiedVRAM();
 
+// How often a texture was cropped out of an already decoded texture page, rather than the page being decoded
+struct TexturePageCacheStatistics
+{
+	unsigned int hits = 0;
+	unsigned int misses = 0;
+};
+
+TexturePageCacheStatistics getTexturePageCacheStatistics();
+
+// Textures are written with PNGImageSink unless another sink is chosen
+void setTextureImageSink(std::unique_ptr<ImageSink> imageSink);
+
+// File extension of the textures, without the dot
+std::string textureImageExtension();
+
+// Writes a texture to path with the chosen image sink, returns 1 if it couldn't be written
+int exportTextureImage(const TextureImage& image, std::string path);
+
+// Texture embedding keeps each material's texture in memory, encoded, instead of writing it, for model formats that hold their own textures
+// Animation frames are still written as files
+void setTextureEmbedding(bool enabled);
+bool textureEmbeddingEnabled();
+
+// Encodes a texture with the chosen image sink and keeps it under fileName, returns 1 if it couldn't be encoded
+int embedTextureImage(const TextureImage& image, std::string fileName);
+
+// Encoded texture kept under fileName, nullptr if there isn't one
+const std::vector<unsigned char>* findEmbeddedTexture(std::string fileName);
+
+// Forgets the embedded textures, once a model has been exported
+void clearEmbeddedTextures();
+
+// Number of threads textures are encoded and written on, 1 encodes them on the thread that exports them
+void setTextureExportJobs(unsigned int jobCount);
+
+// Waits for every texture handed to the encoding threads to be written
+// Returns false, after reporting them, if any textures failed to write since the last call
+bool finishTextureExports();
+
+// Gives back all the texture decoding scratch memory, once a model's textures have been exported
+void resetTextureArena();
+
 int initialiseVRM(std::string path);
 
+int initialiseVRM(const unsigned char* vrmData, size_t vrmSize);
+
 int copyRectangleInVRM(unsigned short int xCoordinateDestination, unsigned short int yCoordinateDestination, unsigned short int xSize, unsigned short int ySize,
     unsigned short int xCoordinateSource, unsigned short int yCoordinateSource, bool useAlreadyModifiedVRAMAsBase);
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <cstddef>
+
+// Kernels for the inner loops of texture decoding
+// Each has a scalar version and, on x86, SSE2 and AVX2 versions; the best one the CPU supports is picked at runtime
+// All versions give bit-identical results
+struct TextureKernels
+{
+	// PS1 15-bit colours (5 bits each of red, green and blue from the bottom, then the semi-transparency bit) to RGBA8
+	// Output pixels are 4 bytes in the order red, green, blue, alpha, with alpha 0 only for a colour of 0 and 255 otherwise
+	void (*convertColours)(const unsigned short int* colours, unsigned int* RGBA, size_t count);
+
+	// Splits VRAM pixels of 4 bit texels into 4 indices each, lowest nibble first
+	void (*expandNibbles)(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount);
+
+	// Splits VRAM pixels of 8 bit texels into 2 indices each, lowest byte first
+	void (*expandBytes)(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount);
+
+	// Looks each index up in an RGBA8 palette to produce a row of RGBA8 pixels
+	void (*lookUpPalette)(const unsigned short int* indices, const unsigned int* palette, unsigned int* RGBA, size_t count);
+
+	const char* name;
+};
+
+// The kernels chosen for this CPU, detected on first use
+const TextureKernels& textureKernels();
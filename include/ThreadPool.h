@@ -0,0 +1,58 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run jobs in the order they were submitted
+// The queue is bounded, so submitting blocks while it is full rather than letting pending jobs pile up in memory
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned int workerCount, size_t maxQueuedJobs);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void submit(std::function<void()> job);
+
+	// Blocks until every job submitted so far has finished
+	void wait();
+
+	unsigned int workerCount() const { return workers.size(); }
+
+private:
+	void work();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	size_t maxQueuedJobs;
+	size_t unfinishedJobs = 0;
+	bool stopping = false;
+
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable spaceAvailable;
+	std::condition_variable allJobsFinished;
+};
@@ -0,0 +1,38 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "ModelStructs.h"
+
+#include <cstddef>
+
+// Bounding box of a set of UVs
+struct UVBounds
+{
+	float left, right;
+	float south, north;
+};
+
+// Kernels that work over a material's packed UVs
+// They use SSE2 when the compiler targets it, otherwise a scalar version that gives bit-identical results
+
+// Finds the smallest and largest u and v in a single pass (count must be at least 1)
+UVBounds findUVBounds(const UV* UVs, size_t count);
+
+// Translates the UVs so the bounding box starts at 0, then stretches it to fill 0 to 1, in place
+// An axis with no width is flattened to 0
+void normaliseUVs(UV* UVs, size_t count, const UVBounds& bounds);
@@ -17,15 +17,16 @@
 #pragma once
 
 #include "ModelStructs.h"
+#include "BinaryCursor.h"
 
-#include <iostream>
+#include <vector>
 
-void readVertices(std::ifstream& reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
+void readVertices(BinaryCursor reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
     unsigned int boneStartAddress, bool isObject, std::vector<Vertex>& vertices);
 
-Vertex readVertex(std::ifstream& reader, unsigned int v);
+Vertex readVertex(BinaryCursor reader, unsigned int v);
 
-void readArmature(std::ifstream& reader, unsigned short int boneCount, unsigned int boneStartAddress, std::vector<Bone>& bones);
+void readArmature(BinaryCursor reader, unsigned short int boneCount, unsigned int boneStartAddress, std::vector<Bone>& bones);
 
-void applyArmature(std::ifstream& reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
+void applyArmature(unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
     unsigned int boneStartAddress, std::vector<Vertex>& vertices, std::vector<Bone>& bones);
\ No newline at end of file
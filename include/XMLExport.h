@@ -16,35 +16,46 @@
 
 #pragma once
 
-#include "tinyxml2.h"
-
 #include "ModelStructs.h"
+#include "XMLWriter.h"
 
 #include <iostream>
 #include <vector>
 
-int exportToXML(std::string outputFolder, std::string objectName, std::vector<PolygonStruct>& polygons, std::vector<Material>& materials);
+// A material's corners welded together, so each input only holds its distinct values once
+// The colour input holds only the material's colour, which every corner uses
+struct WeldedCorners
+{
+	std::vector<int> positions; // X, Y and Z of each distinct position
+	std::vector<float> UVs; // U and V of each distinct UV
+	std::vector<int> cornerIndices; // Position index then UV index of each corner, in polygon order
+};
+
+// The .dae is written straight to the file as it goes, one library at a time
+int exportToXML(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials);
+
+// The image's ID is based on textureName, and it loads textureFileName
+int exportTexture(XMLWriter& outputDAE, Material exportMaterial, std::string textureName, std::string textureFileName);
 
-int exportTexture(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* library_images, Material exportMaterial, std::string objectName);
+// The effect's ID is based on effectName, and for real materials it samples the image with textureName
+int exportEffect(XMLWriter& outputDAE, Material exportMaterial, std::string effectName, std::string textureName);
 
-int exportEffect(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* library_effects, Material exportMaterial, int materialID, std::string objectName);
+int exportMaterial(XMLWriter& outputDAE, Material exportMaterial, int materialID, std::string effectName, std::string objectName);
 
-int exportMaterial(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* material, tinyxml2::XMLElement* library_materials,
-    Material exportMaterial, int materialID, std::string objectName);
+int exportGeometry(XMLWriter& outputDAE, Mesh& modelMesh, Material exportMaterial, int materialID, std::string objectName);
 
-int exportGeometry(tinyxml2::XMLDocument& outputDAE, std::vector<PolygonStruct>& polygons, tinyxml2::XMLElement* geometry, tinyxml2::XMLElement* mesh,
-    tinyxml2::XMLElement* library_geometries, std::vector<PolygonStruct>& meshPolygons, std::vector<Vertex>& meshVertices, Material exportMaterial, int materialID,
-    std::string objectName);
+// Corners with the same position share it, and corners with the same UV share it, found through hash tables
+WeldedCorners weldCorners(Mesh& modelMesh, Material exportMaterial);
 
-int exportPositions(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh,
-    std::vector<PolygonStruct>& meshPolygons, std::vector<Vertex>& meshVertices, int materialID);
+int exportPositions(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, int materialID);
 
-int exportTextures(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, std::vector<PolygonStruct>& meshPolygons, int materialID);
+int exportTextures(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, int materialID);
 
-int exportColours(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, std::vector<PolygonStruct>& meshPolygons, Material exportMaterial, int materialID);
+int exportColours(XMLWriter& outputDAE, Material exportMaterial, int materialID);
 
-int exportVertices(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, int materialID);
+int exportVertices(XMLWriter& outputDAE, int materialID);
 
-int exportPolygons(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, unsigned int meshPolygonsSize, int materialID);
+// Each corner indexes the positions, UVs and colour separately, through the inputs' offsets in <triangles>
+int exportPolygons(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, unsigned int meshPolygonsSize, int materialID);
 
-int exportVisualScene(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* nodeModel, int materialID, std::string objectName);
+int exportVisualScene(XMLWriter& outputDAE, int materialID, std::string objectName);
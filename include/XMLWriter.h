@@ -0,0 +1,79 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#pragma once
+
+#include "BufferedFile.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Writes an XML document straight to a file as it goes, rather than building the whole document in memory first
+// The output is buffered and laid out the same way as tinyxml2's printer: 4 spaces of indentation per level,
+// elements that only hold text on one line, and elements with nothing in them closed with "/>"
+class XMLWriter
+{
+public:
+	XMLWriter() = default;
+	XMLWriter(const XMLWriter&) = delete;
+	XMLWriter& operator=(const XMLWriter&) = delete;
+
+	// Returns false if the file couldn't be created
+	bool open(std::string path);
+
+	// Writes what is left in the buffer and closes the file
+	// Returns false if any part of the document couldn't be written
+	bool close();
+
+	// <?value?>
+	void declaration(std::string_view value);
+
+	// Attributes can only be added straight after the element is opened, before any text or child elements
+	void openElement(const char* name);
+	void attribute(const char* name, std::string_view value);
+	void attribute(const char* name, long long int value);
+	void closeElement();
+
+	// Adds to the text of the element that is open, escaping it where needed
+	void text(std::string_view text);
+
+	// Makes room for up to maxLength characters of text at the end of the element that is open, to be written straight into
+	// endTextInPlace is then given one past the last character that was written, with no escaping done
+	char* beginTextInPlace(size_t maxLength);
+	void endTextInPlace(char* end);
+
+	// An element that only holds text, e.g. <up_axis>Z_UP</up_axis>
+	void textElement(const char* name, std::string_view text);
+
+private:
+	void beginText();
+	void sealElement();
+	void newLine();
+	void writeEscaped(std::string_view text, bool isAttribute);
+
+	BufferedFile file;
+
+	// Names of the elements that are open, the innermost last
+	std::vector<const char*> openElements;
+
+	// An element is left as "<name attributes" until something goes in it, so that it can still be closed with "/>"
+	bool elementJustOpened = false;
+	bool firstNode = true;
+
+	// Depth of the element that has text in it, -1 if none, as elements with text don't get new lines inside them
+	int textDepth = -1;
+};
@@ -0,0 +1,103 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "Bigfile.h"
+
+#include <iostream>
+#include <format>
+
+int readBigfileIndex(BinaryCursor reader, BigfileIndex& index)
+{
+	unsigned int entryCount = reader.read<unsigned int>();
+
+	// A corrupt count would otherwise have the reader run through the whole archive before it hit the end
+	if (((size_t)entryCount * 16) + 4 > reader.size())
+		return 1;
+
+	index.entries.reserve(entryCount);
+	index.entryIDsByHash.reserve(entryCount);
+
+	for (unsigned int i = 0; i < entryCount; i++)
+	{
+		BigfileEntry entry;
+		entry.fileHash = reader.read<unsigned int>();
+		entry.fileLength = reader.read<unsigned int>();
+		entry.fileOffset = reader.read<unsigned int>();
+		entry.checksum = reader.read<unsigned int>();
+
+		index.entries.push_back(entry);
+		index.entryIDsByHash.emplace(entry.fileHash, i);
+	}
+
+	return 0;
+}
+
+const BigfileEntry* findBigfileEntry(const BigfileIndex& index, unsigned int fileHash)
+{
+	auto found = index.entryIDsByHash.find(fileHash);
+	if (found == index.entryIDsByHash.end())
+		return nullptr;
+
+	return &index.entries[found->second];
+}
+
+BinaryCursor getBigfileEntryData(BinaryCursor reader, const BigfileEntry& entry)
+{
+	return reader.subspan(entry.fileOffset, entry.fileLength);
+}
+
+bool parseBigfilePair(std::string argument, BigfilePair& pair)
+{
+	// Format is DRMHASH:VRMHASH, both in hexadecimal
+	size_t separator = argument.find(':');
+	if (separator == std::string::npos)
+		return false;
+
+	std::string hashes[2] = { argument.substr(0, separator), argument.substr(separator + 1) };
+	unsigned int values[2];
+
+	for (int h = 0; h < 2; h++)
+	{
+		if (hashes[h].length() > 2 && hashes[h][0] == '0' && (hashes[h][1] == 'x' || hashes[h][1] == 'X'))
+			hashes[h].erase(0, 2);
+
+		if (hashes[h].empty() || hashes[h].length() > 8)
+			return false;
+
+		values[h] = 0;
+		for (unsigned char digit : hashes[h])
+		{
+			if (!isxdigit(digit))
+				return false;
+			values[h] = (values[h] << 4) + (isdigit(digit) ? digit - '0' : (toupper(digit) - 'A' + 10));
+		}
+	}
+
+	pair.drmHash = values[0];
+	pair.vrmHash = values[1];
+	return true;
+}
+
+void listBigfileEntries(const BigfileIndex& index)
+{
+	for (unsigned int i = 0; i < index.entries.size(); i++)
+	{
+		std::cout << std::format("{}: {:08X} (offset 0x{:X}, length {})", i + 1, index.entries[i].fileHash,
+			index.entries[i].fileOffset, index.entries[i].fileLength) << std::endl;
+	}
+
+	std::cout << "Exit Code 0: Successful listing with no errors" << std::endl;
+}
@@ -0,0 +1,48 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "BufferedFile.h"
+
+BufferedFile::~BufferedFile()
+{
+	if (file)
+		fclose(file);
+}
+
+bool BufferedFile::open(std::string path)
+{
+	file = fopen(path.c_str(), "w");
+	buffer.reserve(bufferSize * 2);
+	return file != nullptr;
+}
+
+bool BufferedFile::close()
+{
+	if (!file)
+		return false;
+
+	flush();
+	bool closed = fclose(file) == 0;
+	file = nullptr;
+	return closed && !writeFailed;
+}
+
+void BufferedFile::flush()
+{
+	if (file && !buffer.empty() && fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+		writeFailed = true;
+	buffer.clear();
+}
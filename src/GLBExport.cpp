@@ -0,0 +1,344 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "GLBExport.h"
+#include "SharedFunctions.h"
+#include "TextureExporter.h"
+#include "TextureAtlas.h"
+#include "NumberFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <unordered_map>
+
+// glTF constants
+constexpr unsigned int GLBMagic = 0x46546C67; // "glTF"
+constexpr unsigned int GLBChunkJSON = 0x4E4F534A;
+constexpr unsigned int GLBChunkBIN = 0x004E4942;
+constexpr unsigned int GLTFArrayBuffer = 34962;
+constexpr unsigned int GLTFElementArrayBuffer = 34963;
+constexpr unsigned int GLTFUnsignedShort = 5123;
+constexpr unsigned int GLTFUnsignedInt = 5125;
+constexpr unsigned int GLTFFloat = 5126;
+
+// A corner of a polygon, which becomes one vertex of the primitive however many polygons share it
+struct GLBCornerKey
+{
+	unsigned short int vertexID;
+	float u;
+	float v;
+
+	bool operator==(const GLBCornerKey& other) const
+	{
+		return vertexID == other.vertexID && u == other.u && v == other.v;
+	}
+};
+
+struct GLBCornerKeyHash
+{
+	size_t operator()(const GLBCornerKey& key) const
+	{
+		unsigned int u, v;
+		std::memcpy(&u, &key.u, sizeof(u));
+		std::memcpy(&v, &key.v, sizeof(v));
+		return std::hash<unsigned long long int>()(((unsigned long long int)u << 32) ^ ((unsigned long long int)v << 16) ^ key.vertexID);
+	}
+};
+
+// The binary chunk and the JSON describing what is in it, built up as the model is written
+struct GLBBuilder
+{
+	std::vector<unsigned char> binary;
+	std::string bufferViews;
+	std::string accessors;
+	unsigned int bufferViewCount = 0;
+	unsigned int accessorCount = 0;
+
+	// Copies data into the binary chunk as a new buffer view, target 0 leaves it without one (for images), returns the buffer view's index
+	unsigned int addBufferView(const void* data, size_t size, unsigned int target)
+	{
+		// Every buffer view starts 4 byte aligned, so that any component type can be read from it
+		binary.resize((binary.size() + 3) & ~(size_t)3, 0);
+		size_t offset = binary.size();
+		binary.insert(binary.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+
+		bufferViews += std::format("{}{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{}", bufferViewCount ? "," : "", offset, size);
+		if (target != 0)
+			bufferViews += std::format(",\"target\":{}", target);
+		bufferViews += "}";
+		return bufferViewCount++;
+	}
+
+	// minMax is the accessor's "min" and "max" properties, which positions have to have
+	unsigned int addAccessor(const void* data, size_t size, unsigned int target, unsigned int componentType, size_t count, const char* type,
+		std::string minMax = "")
+	{
+		unsigned int bufferView = addBufferView(data, size, target);
+		accessors += std::format("{}{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"{}\"{}}}",
+			accessorCount ? "," : "", bufferView, componentType, count, type, minMax);
+		return accessorCount++;
+	}
+};
+
+static void appendFloat(std::string& json, float value)
+{
+	char buffer[maxFormattedNumberLength];
+	json.append(buffer, formatFloat(buffer, value));
+}
+
+// Object names go in the JSON as strings, so quotes, backslashes and control characters have to be escaped
+static std::string JSONString(std::string text)
+{
+	std::string escaped = "\"";
+	for (char character : text)
+	{
+		if (character == '"' || character == '\\')
+		{
+			escaped += '\\';
+			escaped += character;
+		}
+		else if ((unsigned char)character < 0x20)
+			escaped += std::format("\\u{:04x}", (unsigned int)(unsigned char)character);
+		else
+			escaped += character;
+	}
+	return escaped + "\"";
+}
+
+// The colour the .dae gives a fake material, in linear RGB
+// Real materials never have their colour read in, so they don't have one
+static void materialColour(const Material& material, float colour[3])
+{
+	colour[0] = rgbToLinearRgb(material.redVal) / 1.25f;
+	colour[1] = rgbToLinearRgb(material.greenVal) / 1.25f;
+	colour[2] = rgbToLinearRgb(material.blueVal) / 1.25f;
+}
+
+static bool writeGLBChunk(FILE* file, unsigned int type, const void* data, size_t size, unsigned char padding)
+{
+	size_t paddedSize = (size + 3) & ~(size_t)3;
+	unsigned int header[2] = { (unsigned int)paddedSize, type };
+	static const unsigned char paddingBytes[4][4] = { { 0, 0, 0, 0 }, { ' ', ' ', ' ', ' ' } };
+
+	return fwrite(header, sizeof(header), 1, file) == 1
+		&& fwrite(data, 1, size, file) == size
+		&& fwrite(paddingBytes[padding == ' '], 1, paddedSize - size, file) == paddedSize - size;
+}
+
+int exportToGLB(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials)
+{
+	int returnValue = 0;
+
+	GLBBuilder builder;
+	std::string primitives;
+	std::string materialsJSON;
+	std::string textures;
+	std::string images;
+	std::unordered_map<std::string, unsigned int> imageIDsByFileName;
+
+	std::vector<float> positions;
+	std::vector<float> UVs;
+	std::vector<unsigned int> indices;
+	std::unordered_map<GLBCornerKey, unsigned int, GLBCornerKeyHash> vertexIDsByCorner;
+
+	for (unsigned int m = 0; m < materials.size(); m++)
+	{
+		const Material& material = materials[m];
+
+		if (!material.properlyExported)
+			returnValue = 1;
+
+		// Real materials that exported properly sample their texture, and the rest just have their colour
+		std::string textureFileName = textureAtlasEnabled() ? textureAtlasFileName(objectName)
+			: std::format("{}-tex{}.{}", objectName, material.textureID + 1, textureImageExtension());
+		const std::vector<unsigned char>* texture = material.realMaterial && material.properlyExported ? findEmbeddedTexture(textureFileName) : nullptr;
+
+		materialsJSON += std::format("{}{{\"name\":{},\"pbrMetallicRoughness\":{{", m ? "," : "", JSONString(std::format("{}-mat{}", objectName, m)));
+		if (texture)
+		{
+			auto image = imageIDsByFileName.find(textureFileName);
+			if (image == imageIDsByFileName.end())
+			{
+				unsigned int bufferView = builder.addBufferView(texture->data(), texture->size(), 0);
+				images += std::format("{}{{\"name\":{},\"bufferView\":{},\"mimeType\":\"image/png\"}}", imageIDsByFileName.empty() ? "" : ",",
+					JSONString(textureFileName), bufferView);
+				textures += std::format("{}{{\"sampler\":0,\"source\":{}}}", imageIDsByFileName.empty() ? "" : ",", imageIDsByFileName.size());
+				image = imageIDsByFileName.emplace(textureFileName, imageIDsByFileName.size()).first;
+			}
+			materialsJSON += std::format("\"baseColorTexture\":{{\"index\":{}}},", image->second);
+		}
+		else
+		{
+			// Materials without a texture just have a colour, which is white for real materials that didn't export
+			float colour[3] = { 1.0f, 1.0f, 1.0f };
+			if (!material.realMaterial)
+				materialColour(material, colour);
+
+			materialsJSON += "\"baseColorFactor\":[";
+			for (float component : colour)
+			{
+				appendFloat(materialsJSON, component);
+				materialsJSON += ",";
+			}
+			materialsJSON += "1],";
+		}
+		materialsJSON += "\"metallicFactor\":0,\"roughnessFactor\":1}";
+		// Colour 0 in a texture is transparent
+		if (texture)
+			materialsJSON += ",\"alphaMode\":\"MASK\"";
+		materialsJSON += "}";
+
+		if (material.polygonCount == 0)
+			continue;
+
+		// Each distinct corner becomes a vertex
+		positions.clear();
+		UVs.clear();
+		indices.clear();
+		vertexIDsByCorner.clear();
+
+		float minimum[3] = { 0, 0, 0 };
+		float maximum[3] = { 0, 0, 0 };
+
+		for (unsigned int p = material.polygonStart; p < material.polygonStart + material.polygonCount; p++)
+		{
+			const PolygonStruct& polygon = modelMesh.polygons[p];
+			const unsigned short int corners[3] = { polygon.v1, polygon.v2, polygon.v3 };
+
+			for (unsigned int c = 0; c < 3; c++)
+			{
+				const UV& cornerUV = modelMesh.UVs[(p * 3) + c];
+				GLBCornerKey key = { corners[c], cornerUV.u, cornerUV.v };
+				auto [corner, isNew] = vertexIDsByCorner.emplace(key, (unsigned int)(positions.size() / 3));
+
+				if (isNew)
+				{
+					// The .dae is Z up and glTF is Y up, so Y and Z swap, with Z negated to keep it right handed
+					const Vertex& vertex = modelMesh.vertices[corners[c]];
+					float position[3] = { vertex.finalX / 1000.0f, vertex.finalZ / 1000.0f, -vertex.finalY / 1000.0f };
+					for (unsigned int i = 0; i < 3; i++)
+					{
+						if (positions.empty() || position[i] < minimum[i])
+							minimum[i] = position[i];
+						if (positions.empty() || position[i] > maximum[i])
+							maximum[i] = position[i];
+					}
+					positions.insert(positions.end(), position, position + 3);
+
+					// glTF UVs start from the top of the image rather than the bottom
+					UVs.push_back(cornerUV.u);
+					UVs.push_back(1.0f - cornerUV.v);
+				}
+				indices.push_back(corner->second);
+			}
+		}
+
+		size_t vertexCount = positions.size() / 3;
+
+		std::string positionBounds = ",\"min\":[";
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			appendFloat(positionBounds, minimum[i]);
+			positionBounds += i < 2 ? "," : "],\"max\":[";
+		}
+		for (unsigned int i = 0; i < 3; i++)
+		{
+			appendFloat(positionBounds, maximum[i]);
+			positionBounds += i < 2 ? "," : "]";
+		}
+
+		unsigned int positionAccessor = builder.addAccessor(positions.data(), positions.size() * sizeof(float), GLTFArrayBuffer, GLTFFloat,
+			vertexCount, "VEC3", positionBounds);
+		primitives += std::format("{}{{\"attributes\":{{\"POSITION\":{}", primitives.empty() ? "" : ",", positionAccessor);
+
+		if (texture)
+		{
+			unsigned int UVAccessor = builder.addAccessor(UVs.data(), UVs.size() * sizeof(float), GLTFArrayBuffer, GLTFFloat, vertexCount, "VEC2");
+			primitives += std::format(",\"TEXCOORD_0\":{}", UVAccessor);
+		}
+
+		// There's no COLOR_0, as glTF would multiply it into the texture, and fake materials already have their colour as the base colour
+
+		// Indices are 16 bit unless the primitive has too many vertices for them
+		unsigned int indexAccessor;
+		if (vertexCount <= 0xFFFF)
+		{
+			std::vector<unsigned short int> shortIndices(indices.begin(), indices.end());
+			indexAccessor = builder.addAccessor(shortIndices.data(), shortIndices.size() * sizeof(unsigned short int), GLTFElementArrayBuffer,
+				GLTFUnsignedShort, indices.size(), "SCALAR");
+		}
+		else
+		{
+			indexAccessor = builder.addAccessor(indices.data(), indices.size() * sizeof(unsigned int), GLTFElementArrayBuffer,
+				GLTFUnsignedInt, indices.size(), "SCALAR");
+		}
+		primitives += std::format("}},\"indices\":{},\"material\":{}}}", indexAccessor, m);
+	}
+
+	// The binary chunk's length has to be a multiple of 4
+	builder.binary.resize((builder.binary.size() + 3) & ~(size_t)3, 0);
+
+	std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"Gex 2 PS1 Model Exporter\"},\"scene\":0";
+	json += std::format(",\"scenes\":[{{\"name\":{},\"nodes\":[0]}}]", JSONString(objectName));
+	if (primitives.empty())
+		json += std::format(",\"nodes\":[{{\"name\":{}}}]", JSONString(objectName));
+	else
+	{
+		json += std::format(",\"nodes\":[{{\"name\":{},\"mesh\":0}}]", JSONString(objectName));
+		json += std::format(",\"meshes\":[{{\"name\":{},\"primitives\":[{}]}}]", JSONString(objectName), primitives);
+	}
+	if (!materialsJSON.empty())
+		json += std::format(",\"materials\":[{}]", materialsJSON);
+	if (!images.empty())
+	{
+		// Nearest filtering and clamping, as the PS1 does
+		json += std::format(",\"textures\":[{}],\"images\":[{}]", textures, images);
+		json += ",\"samplers\":[{\"magFilter\":9728,\"minFilter\":9728,\"wrapS\":33071,\"wrapT\":33071}]";
+	}
+	if (builder.accessorCount != 0)
+		json += std::format(",\"accessors\":[{}]", builder.accessors);
+	if (builder.bufferViewCount != 0)
+	{
+		json += std::format(",\"bufferViews\":[{}]", builder.bufferViews);
+		json += std::format(",\"buffers\":[{{\"byteLength\":{}}}]", builder.binary.size());
+	}
+	json += "}";
+
+	if (!std::filesystem::exists(outputFolder))
+		return 2;
+
+	FILE* file = fopen(std::format("{}{}{}.glb", outputFolder, directorySeparator(), objectName).c_str(), "wb");
+	if (!file)
+		return 2;
+
+	// 12 byte header, then the JSON chunk padded with spaces and the binary chunk padded with zeros, each with an 8 byte chunk header
+	size_t fileLength = 12 + 8 + ((json.size() + 3) & ~(size_t)3);
+	if (!builder.binary.empty())
+		fileLength += 8 + builder.binary.size();
+	unsigned int header[3] = { GLBMagic, 2, (unsigned int)fileLength };
+
+	bool written = fwrite(header, sizeof(header), 1, file) == 1
+		&& writeGLBChunk(file, GLBChunkJSON, json.data(), json.size(), ' ')
+		&& (builder.binary.empty() || writeGLBChunk(file, GLBChunkBIN, builder.binary.data(), builder.binary.size(), 0));
+
+	if (fclose(file) != 0 || !written)
+		return 2;
+
+	return returnValue;
+}
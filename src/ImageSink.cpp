@@ -0,0 +1,327 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "png.h"
+
+#include "ImageSink.h"
+#include "TextureKernels.h"
+
+#include <cstring>
+#include <algorithm>
+
+void expandTextureRow(const TextureImage& image, unsigned int y, unsigned int* RGBA)
+{
+	const unsigned short int* texels = &image.texels[y * image.texelStride];
+
+	if (image.bitDepth == 0)
+		textureKernels().convertColours(texels, RGBA, image.width);
+	else
+		textureKernels().lookUpPalette(texels, image.palette, RGBA, image.width);
+}
+
+// Turns an RGBA8 palette entry back into the 15-bit colour it was made from
+// Opaque black is the only colour that needs the semi-transparency bit, to keep it from being transparent
+static unsigned short int RGBAToColour(unsigned int RGBA)
+{
+	const unsigned char* colour = reinterpret_cast<const unsigned char*>(&RGBA);
+	unsigned short int value = (colour[0] >> 3) | ((colour[1] >> 3) << 5) | ((colour[2] >> 3) << 10);
+	if (value == 0 && colour[3] != 0)
+		value = 0x8000;
+	return value;
+}
+
+void textureImageToColours(const TextureImage& image, unsigned short int* colours)
+{
+	// Only as much of the palette as the texels can index is converted
+	unsigned short int palette[256];
+	unsigned int paletteSize = std::min(image.paletteSize, 256u);
+	for (unsigned int i = 0; i < paletteSize; i++)
+		palette[i] = RGBAToColour(image.palette[i]);
+
+	for (unsigned int y = 0; y < image.height; y++)
+	{
+		const unsigned short int* texels = &image.texels[y * image.texelStride];
+		unsigned short int* row = &colours[y * image.width];
+
+		if (image.bitDepth == 0)
+			std::memcpy(row, texels, image.width * sizeof(unsigned short int));
+		else
+		{
+			for (unsigned int x = 0; x < image.width; x++)
+				row[x] = palette[texels[x]];
+		}
+	}
+}
+
+static void writePNGToVector(png_structp pngPointer, png_bytep data, png_size_t length)
+{
+	std::vector<unsigned char>* encoded = static_cast<std::vector<unsigned char>*>(png_get_io_ptr(pngPointer));
+	encoded->insert(encoded->end(), data, data + length);
+}
+
+static void flushPNGToVector(png_structp)
+{
+}
+
+bool PNGImageSink::encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded)
+{
+	png_structp pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (!pngPointer)
+		return false;
+	png_infop infoPointer = png_create_info_struct(pngPointer);
+	if (!infoPointer)
+	{
+		png_destroy_write_struct(&pngPointer, NULL);
+		return false;
+	}
+
+	encoded.clear();
+	png_set_write_fn(pngPointer, &encoded, writePNGToVector, flushPNGToVector);
+
+	if (compressionLevel >= 0)
+		png_set_compression_level(pngPointer, compressionLevel);
+	if (filters >= 0)
+		png_set_filter(pngPointer, PNG_FILTER_TYPE_BASE, filters);
+
+	// The rows belong to the arena, libpng doesn't free rows it was given with png_set_rows
+	png_byte** rowPointers = arena.allocate<png_byte*>(image.height);
+
+	if (image.bitDepth == 0)
+	{
+		png_set_IHDR(pngPointer, infoPointer, image.width, image.height, 8,
+			PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+		for (unsigned int y = 0; y < image.height; y++)
+		{
+			unsigned int* row = arena.allocate<unsigned int>(image.width);
+			expandTextureRow(image, y, row);
+			rowPointers[y] = reinterpret_cast<png_byte*>(row);
+		}
+	}
+	else
+	{
+		// The alpha of each palette entry goes in a tRNS chunk, which can stop at the last entry that isn't opaque
+		png_color* palette = arena.allocate<png_color>(image.paletteSize);
+		png_byte* paletteAlpha = arena.allocate<png_byte>(image.paletteSize);
+		unsigned int transparentEntries = 0;
+
+		for (unsigned int i = 0; i < image.paletteSize; i++)
+		{
+			const unsigned char* colour = reinterpret_cast<const unsigned char*>(&image.palette[i]);
+			palette[i].red = colour[0];
+			palette[i].green = colour[1];
+			palette[i].blue = colour[2];
+			paletteAlpha[i] = colour[3];
+
+			if (colour[3] != 255)
+				transparentEntries = i + 1;
+		}
+
+		png_set_IHDR(pngPointer, infoPointer, image.width, image.height, image.bitDepth,
+			PNG_COLOR_TYPE_PALETTE, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+		png_set_PLTE(pngPointer, infoPointer, palette, image.paletteSize);
+		if (transparentEntries > 0)
+			png_set_tRNS(pngPointer, infoPointer, paletteAlpha, transparentEntries, NULL);
+
+		// At 4 bits, the leftmost of each pair of texels goes in the high nibble
+		unsigned int rowBytes = image.bitDepth == 4 ? (image.width + 1) / 2 : image.width;
+
+		for (unsigned int y = 0; y < image.height; y++)
+		{
+			png_byte* row = arena.allocate<png_byte>(rowBytes);
+			const unsigned short int* texels = &image.texels[y * image.texelStride];
+
+			if (image.bitDepth == 4)
+			{
+				for (unsigned int x = 0; x < image.width; x += 2)
+				{
+					unsigned char secondTexel = x + 1 < image.width ? texels[x + 1] : 0;
+					row[x / 2] = (texels[x] << 4) | secondTexel;
+				}
+			}
+			else
+			{
+				for (unsigned int x = 0; x < image.width; x++)
+					row[x] = texels[x];
+			}
+
+			rowPointers[y] = row;
+		}
+	}
+
+	png_set_rows(pngPointer, infoPointer, rowPointers);
+	png_write_png(pngPointer, infoPointer, PNG_TRANSFORM_IDENTITY, NULL);
+
+	png_destroy_write_struct(&pngPointer, &infoPointer);
+
+	return true;
+}
+
+bool TGAImageSink::encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded)
+{
+	// Uncompressed true colour, 32 bits per pixel with 8 of them alpha, stored top row first
+	unsigned char header[18] = { 0 };
+	header[2] = 2;
+	header[12] = image.width & 0xFF;
+	header[13] = (image.width >> 8) & 0xFF;
+	header[14] = image.height & 0xFF;
+	header[15] = (image.height >> 8) & 0xFF;
+	header[16] = 32;
+	header[17] = 0x28;
+
+	encoded.resize(sizeof(header) + (image.width * image.height * 4));
+	std::memcpy(encoded.data(), header, sizeof(header));
+
+	unsigned int* RGBA = arena.allocate<unsigned int>(image.width);
+	unsigned char* pixel = encoded.data() + sizeof(header);
+
+	for (unsigned int y = 0; y < image.height; y++)
+	{
+		expandTextureRow(image, y, RGBA);
+
+		const unsigned char* colour = reinterpret_cast<const unsigned char*>(RGBA);
+		for (unsigned int x = 0; x < image.width; x++, colour += 4)
+		{
+			*pixel++ = colour[2];
+			*pixel++ = colour[1];
+			*pixel++ = colour[0];
+			*pixel++ = colour[3];
+		}
+	}
+
+	return true;
+}
+
+bool QOIImageSink::encode(const TextureImage& image, ScratchArena& arena, std::vector<unsigned char>& encoded)
+{
+	encoded.clear();
+	encoded.reserve(14 + (image.width * image.height * 5) + 8);
+
+	auto writeBigEndian = [&encoded](unsigned int value)
+	{
+		encoded.push_back((value >> 24) & 0xFF);
+		encoded.push_back((value >> 16) & 0xFF);
+		encoded.push_back((value >> 8) & 0xFF);
+		encoded.push_back(value & 0xFF);
+	};
+
+	// Header: magic, width, height, 4 channels, sRGB with linear alpha
+	encoded.insert(encoded.end(), { 'q', 'o', 'i', 'f' });
+	writeBigEndian(image.width);
+	writeBigEndian(image.height);
+	encoded.push_back(4);
+	encoded.push_back(0);
+
+	unsigned char seen[64][4] = { { 0 } };
+	unsigned char previous[4] = { 0, 0, 0, 255 };
+	unsigned int run = 0;
+
+	unsigned int* RGBA = arena.allocate<unsigned int>(image.width);
+
+	for (unsigned int y = 0; y < image.height; y++)
+	{
+		expandTextureRow(image, y, RGBA);
+
+		for (unsigned int x = 0; x < image.width; x++)
+		{
+			const unsigned char* colour = reinterpret_cast<const unsigned char*>(&RGBA[x]);
+			bool lastPixel = y == image.height - 1 && x == image.width - 1;
+
+			if (std::memcmp(colour, previous, 4) == 0)
+			{
+				run++;
+				if (run == 62 || lastPixel)
+				{
+					encoded.push_back(0xC0 | (run - 1));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0)
+			{
+				encoded.push_back(0xC0 | (run - 1));
+				run = 0;
+			}
+
+			unsigned int hash = ((colour[0] * 3) + (colour[1] * 5) + (colour[2] * 7) + (colour[3] * 11)) % 64;
+
+			if (std::memcmp(seen[hash], colour, 4) == 0)
+				encoded.push_back(hash);
+			else
+			{
+				std::memcpy(seen[hash], colour, 4);
+
+				if (colour[3] == previous[3])
+				{
+					signed char redDifference = colour[0] - previous[0];
+					signed char greenDifference = colour[1] - previous[1];
+					signed char blueDifference = colour[2] - previous[2];
+					signed char redGreenDifference = redDifference - greenDifference;
+					signed char blueGreenDifference = blueDifference - greenDifference;
+
+					if (redDifference > -3 && redDifference < 2 && greenDifference > -3 && greenDifference < 2
+						&& blueDifference > -3 && blueDifference < 2)
+						encoded.push_back(0x40 | ((redDifference + 2) << 4) | ((greenDifference + 2) << 2) | (blueDifference + 2));
+					else if (redGreenDifference > -9 && redGreenDifference < 8 && greenDifference > -33 && greenDifference < 32
+						&& blueGreenDifference > -9 && blueGreenDifference < 8)
+					{
+						encoded.push_back(0x80 | (greenDifference + 32));
+						encoded.push_back(((redGreenDifference + 8) << 4) | (blueGreenDifference + 8));
+					}
+					else
+						encoded.insert(encoded.end(), { 0xFE, colour[0], colour[1], colour[2] });
+				}
+				else
+					encoded.insert(encoded.end(), { 0xFF, colour[0], colour[1], colour[2], colour[3] });
+			}
+
+			std::memcpy(previous, colour, 4);
+		}
+	}
+
+	encoded.insert(encoded.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+	return true;
+}
+
+int parsePNGFilter(std::string filterName)
+{
+	if (filterName == "none")
+		return PNG_FILTER_NONE;
+	if (filterName == "sub")
+		return PNG_FILTER_SUB;
+	if (filterName == "up")
+		return PNG_FILTER_UP;
+	if (filterName == "avg")
+		return PNG_FILTER_AVG;
+	if (filterName == "paeth")
+		return PNG_FILTER_PAETH;
+	if (filterName == "all")
+		return PNG_ALL_FILTERS;
+	return -1;
+}
+
+std::unique_ptr<ImageSink> createImageSink(std::string format, int pngCompressionLevel, int pngFilters)
+{
+	if (format == "png")
+		return std::make_unique<PNGImageSink>(pngCompressionLevel, pngFilters);
+	if (format == "tga")
+		return std::make_unique<TGAImageSink>();
+	if (format == "qoi")
+		return std::make_unique<QOIImageSink>();
+	return nullptr;
+}
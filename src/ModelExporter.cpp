@@ -20,18 +20,26 @@
 #include "ModelExporter.h"
 #include "ModelNamesLister.h"
 #include "TextureExporter.h"
+#include "TextureAtlas.h"
+#include "SpriteSheet.h"
 #include "VerticesInterpreter.h"
 #include "PolygonsInterpreter.h"
 #include "XMLExport.h"
+#include "GLBExport.h"
+#include "OBJExport.h"
 #include "Constants.h"
+#include "MappedFile.h"
+#include "Bigfile.h"
 
 #include <format>
 #include <filesystem>
 #include <vector>
 #include <math.h>
 #include <getopt.h>
+#include <thread>
+#include <algorithm>
 
-std::string tempFile = std::format("{}{}Gex2PS1ModelExporterTempfile.drm", tempDirectory(), directorySeparator());
+ModelFormat modelFormat = ModelFormat::DAE;
 
 int main(int argc, char* argv[])
 {
@@ -45,16 +53,59 @@ int main(int argc, char* argv[])
 
 	bool listNamesBool = false;
 
+	// Bigfile mode reads DRM/VRM pairs straight out of BIGFILE.DAT rather than from extracted files
+	bool bigfileBool = false;
+	std::vector<BigfilePair> bigfilePairs;
+
+	// Textures are written as PNG at libpng's default compression level and filters unless these are given
+	std::string imageFormat = "png";
+	int pngCompressionLevel = -1;
+	int pngFilters = -1;
+
+	// Number of threads textures are encoded on
+	int jobCount = 1;
+
+	// Atlas mode packs each model's textures into one image
+	bool atlasBool = false;
+
+	// Sprite sheet mode writes each texture's animation frames into one image
+	bool spriteSheetBool = false;
+
+	std::string modelFormatName = "dae";
+
+	const std::string usage = "Usage: gex2ps1modelexporter file [-o --out folder] [-i --index number] [-l --list] [-b --bigfile] [-e --entry drmhash:vrmhash]"
+		" [-j --jobs number] [--image-format png|tga|qoi] [--png-level 0-9] [--png-filter none|sub|up|avg|paeth|all] [--atlas] [--sprite-sheets] [--format dae|glb|obj]";
+
+	// Options that only have a long form
+	enum LongOnlyOptions
+	{
+		OPTION_IMAGE_FORMAT = 256,
+		OPTION_PNG_LEVEL,
+		OPTION_PNG_FILTER,
+		OPTION_ATLAS,
+		OPTION_SPRITE_SHEETS,
+		OPTION_MODEL_FORMAT
+	};
+
 	static struct option long_options[] =
 	{
 		{"out", required_argument, 0, 'o'},
 		{"index", required_argument, 0, 'i'},
 		{"list", no_argument, 0, 'l'},
+		{"bigfile", no_argument, 0, 'b'},
+		{"entry", required_argument, 0, 'e'},
+		{"jobs", required_argument, 0, 'j'},
+		{"image-format", required_argument, 0, OPTION_IMAGE_FORMAT},
+		{"png-level", required_argument, 0, OPTION_PNG_LEVEL},
+		{"png-filter", required_argument, 0, OPTION_PNG_FILTER},
+		{"atlas", no_argument, 0, OPTION_ATLAS},
+		{"sprite-sheets", no_argument, 0, OPTION_SPRITE_SHEETS},
+		{"format", required_argument, 0, OPTION_MODEL_FORMAT},
 		{0, 0, 0, 0}
 	};
 
 	int opt;
-	while ((opt = getopt_long(argc, argv, "o:i:l", long_options, NULL)) != -1)
+	while ((opt = getopt_long(argc, argv, "o:i:lbe:j:", long_options, NULL)) != -1)
 	{
 		switch (opt)
 		{
@@ -64,7 +115,7 @@ int main(int argc, char* argv[])
 			case 'i':
 				if ((selectedModelExport = stringToInt(optarg, -2)) < -1)
 				{
-					std::cerr << "Usage: gex2ps1modelexporter file [-o --out folder] [-i --index number] [-l --list]" << std::endl;
+					std::cerr << usage << std::endl;
 					std::cerr << std::format("Error {}: Selected model index is invalid", EXIT_INDEX_FAILED_PARSE) << std::endl;
 					return EXIT_INDEX_FAILED_PARSE;
 				}
@@ -72,8 +123,63 @@ int main(int argc, char* argv[])
 			case 'l':
 				listNamesBool = true;
 				break;
+			case 'b':
+				bigfileBool = true;
+				break;
+			case 'e':
+			{
+				BigfilePair pair;
+				if (!parseBigfilePair(optarg, pair))
+				{
+					std::cerr << usage << std::endl;
+					std::cerr << std::format("Error {}: Bigfile entry must be two hexadecimal hashes in the form drmhash:vrmhash", EXIT_BAD_ARGS) << std::endl;
+					return EXIT_BAD_ARGS;
+				}
+				bigfilePairs.push_back(pair);
+				break;
+			}
+			case 'j':
+				if ((jobCount = stringToInt(optarg, -1)) < 0)
+				{
+					std::cerr << usage << std::endl;
+					std::cerr << std::format("Error {}: Number of jobs is invalid", EXIT_BAD_ARGS) << std::endl;
+					return EXIT_BAD_ARGS;
+				}
+				// 0 uses every hardware thread
+				if (jobCount == 0)
+					jobCount = std::max(1u, std::thread::hardware_concurrency());
+				break;
+			case OPTION_IMAGE_FORMAT:
+				imageFormat = optarg;
+				break;
+			case OPTION_PNG_LEVEL:
+				pngCompressionLevel = stringToInt(optarg, -1);
+				if (pngCompressionLevel < 0 || pngCompressionLevel > 9)
+				{
+					std::cerr << usage << std::endl;
+					std::cerr << std::format("Error {}: PNG compression level must be from 0 to 9", EXIT_BAD_ARGS) << std::endl;
+					return EXIT_BAD_ARGS;
+				}
+				break;
+			case OPTION_PNG_FILTER:
+				if ((pngFilters = parsePNGFilter(optarg)) < 0)
+				{
+					std::cerr << usage << std::endl;
+					std::cerr << std::format("Error {}: PNG filter must be none, sub, up, avg, paeth or all", EXIT_BAD_ARGS) << std::endl;
+					return EXIT_BAD_ARGS;
+				}
+				break;
+			case OPTION_ATLAS:
+				atlasBool = true;
+				break;
+			case OPTION_SPRITE_SHEETS:
+				spriteSheetBool = true;
+				break;
+			case OPTION_MODEL_FORMAT:
+				modelFormatName = optarg;
+				break;
 			default:
-				std::cerr << "Usage: gex2ps1modelexporter file [-o --out folder] [-i --index number] [-l --list]" << std::endl;
+				std::cerr << usage << std::endl;
 				std::cerr << std::format("Error {}: Arguments not formatted properly", EXIT_BAD_ARGS) << std::endl;
 				return EXIT_BAD_ARGS;
 		}
@@ -84,27 +190,65 @@ int main(int argc, char* argv[])
 		inputFile = argv[optind];
 	else
 	{
-		std::cerr << "Usage: gex2ps1modelexporter file [-o --out folder] [-i --index number] [-l --list]" << std::endl;
+		std::cerr << usage << std::endl;
 		std::cerr << std::format("Error {}: Need at least the input file to work", EXIT_INSUFFICIENT_ARGS) << std::endl;
 		return EXIT_INSUFFICIENT_ARGS;
 	}
 
-	if (!std::filesystem::exists(inputFile))
+	if (bigfileBool && bigfilePairs.empty() && !listNamesBool)
 	{
-		// Input file doesn't exist
-		std::cerr << std::format("Error {}: Input file does not exist", EXIT_INPUT_NOT_FOUND) << std::endl;
-		return EXIT_INPUT_NOT_FOUND;
+		std::cerr << usage << std::endl;
+		std::cerr << std::format("Error {}: Need at least one entry to export from the bigfile", EXIT_INSUFFICIENT_ARGS) << std::endl;
+		return EXIT_INSUFFICIENT_ARGS;
 	}
 
-	std::ifstream reader(inputFile, std::ifstream::binary);
-	reader.exceptions(std::ifstream::eofbit);
+	if (!bigfileBool && !bigfilePairs.empty())
+	{
+		std::cerr << usage << std::endl;
+		std::cerr << std::format("Error {}: Entries can only be used alongside the bigfile flag", EXIT_BAD_ARGS) << std::endl;
+		return EXIT_BAD_ARGS;
+	}
 
-	if (!reader.is_open())
+	std::unique_ptr<ImageSink> imageSink = createImageSink(imageFormat, pngCompressionLevel, pngFilters);
+	if (!imageSink)
+	{
+		std::cerr << usage << std::endl;
+		std::cerr << std::format("Error {}: Image format must be png, tga or qoi", EXIT_BAD_ARGS) << std::endl;
+		return EXIT_BAD_ARGS;
+	}
+	setTextureImageSink(std::move(imageSink));
+
+	if (modelFormatName == "dae")
+		modelFormat = ModelFormat::DAE;
+	else if (modelFormatName == "glb")
+		modelFormat = ModelFormat::GLB;
+	else if (modelFormatName == "obj")
+		modelFormat = ModelFormat::OBJ;
+	else
 	{
-		std::cerr << std::format("Error {}: Failed to read input file", EXIT_INPUT_FAILED_READ) << std::endl;
-		return EXIT_INPUT_FAILED_READ;
+		std::cerr << usage << std::endl;
+		std::cerr << std::format("Error {}: Model format must be dae, glb or obj", EXIT_BAD_ARGS) << std::endl;
+		return EXIT_BAD_ARGS;
 	}
 
+	// glTF can only embed PNG (or JPEG) images
+	if (modelFormat == ModelFormat::GLB && imageFormat != "png")
+	{
+		std::cerr << usage << std::endl;
+		std::cerr << std::format("Error {}: Textures embedded in glb models have to be png", EXIT_BAD_ARGS) << std::endl;
+		return EXIT_BAD_ARGS;
+	}
+	setTextureEmbedding(modelFormat == ModelFormat::GLB);
+	setTextureExportJobs(jobCount);
+	setTextureAtlasEnabled(atlasBool);
+	setSpriteSheetsEnabled(spriteSheetBool);
+
+	if (!std::filesystem::exists(inputFile))
+	{
+		// Input file doesn't exist
+		std::cerr << std::format("Error {}: Input file does not exist", EXIT_INPUT_NOT_FOUND) << std::endl;
+		return EXIT_INPUT_NOT_FOUND;
+	}
 
 	if (!std::filesystem::is_directory(outputFolder))
 	{
@@ -113,29 +257,45 @@ int main(int argc, char* argv[])
 		return EXIT_OUTPUT_NOT_FOUND;
 	}
 
-	outputFolder = outputFolder + directorySeparator() + getFileNameWithoutExtension(inputFile, false);
-
 	bool modelFailedToExport = false;
 	bool textureFailedToExport = false;
 	bool atLeastOneExportedSuccessfully = false;
 
+	int readReturnCode;
 
-	switch (readFile(reader, inputFile, outputFolder, selectedModelExport, listNamesBool,
-		modelFailedToExport, textureFailedToExport, atLeastOneExportedSuccessfully))
+	if (bigfileBool)
+	{
+		// Each pair gets its own folder in the output folder, named after the DRM hash
+		readReturnCode = readBigfile(inputFile, bigfilePairs, outputFolder, selectedModelExport, listNamesBool,
+			modelFailedToExport, textureFailedToExport, atLeastOneExportedSuccessfully);
+	}
+	else
+	{
+		outputFolder = outputFolder + directorySeparator() + getFileNameWithoutExtension(inputFile, false);
+
+		readReturnCode = readFile(inputFile, outputFolder, selectedModelExport, listNamesBool,
+			modelFailedToExport, textureFailedToExport, atLeastOneExportedSuccessfully);
+	}
+
+	// Textures may still be being written by the encoding threads
+	if (!finishTextureExports())
+		textureFailedToExport = true;
+
+	switch (readReturnCode)
 	{
 		case 1:
 			// End of stream exception
 			std::cerr << std::format("Error {}: End of stream exception", EXIT_END_OF_STREAM) << std::endl;
 			return EXIT_END_OF_STREAM;
 		case 2:
-			// Failed to write temp file to temp dir
-			std::cerr << std::format("Error {}: Failed to write tempfile", EXIT_TEMPFILE_FAILED_WRITE) << std::endl;
-			return EXIT_TEMPFILE_FAILED_WRITE;
-		case 3:
-			// Failed to read temp file
-			std::cerr << std::format("Error {}: Failed to read tempfile", EXIT_TEMPFILE_FAILED_READ) << std::endl;
-			return EXIT_TEMPFILE_FAILED_READ;
+			// Failed to map input file into memory
+			std::cerr << std::format("Error {}: Failed to read input file", EXIT_INPUT_FAILED_READ) << std::endl;
+			return EXIT_INPUT_FAILED_READ;
 	}
+
+	TexturePageCacheStatistics cacheStatistics = getTexturePageCacheStatistics();
+	if (cacheStatistics.hits + cacheStatistics.misses > 0)
+		std::cout << std::format("Texture page cache: {} hits, {} misses", cacheStatistics.hits, cacheStatistics.misses) << std::endl;
 	
 
 	if (listNamesBool)
@@ -163,60 +323,123 @@ int main(int argc, char* argv[])
 
 
 
-int readFile(std::ifstream& reader, std::string inputFile, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+int readFile(std::string inputFile, std::string outputFolder, int selectedModelExport, bool listNamesBool,
 	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully)
 {
-	unsigned int modelsAddressesStart;
+	MappedFile inputMapping;
+
+	if (!inputMapping.open(inputFile))
+		return 2;
+
+	initialiseVRM(std::format("{}.vrm", getFileNameWithoutExtension(inputFile, true)));
+
+	std::cout << std::format("Reading from {}...", inputFile) << std::endl;
+
+	return readDRM(BinaryCursor(inputMapping.data(), inputMapping.size()), getFileNameWithoutExtension(inputFile, false), outputFolder,
+		selectedModelExport, listNamesBool, modelFailedToExport, textureFailedToExport, atLeastOneExportedSuccessfully);
+}
+
+int readBigfile(std::string inputFile, std::vector<BigfilePair>& bigfilePairs, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully)
+{
+	MappedFile bigfileMapping;
+
+	if (!bigfileMapping.open(inputFile))
+		return 2;
+
+	BinaryCursor bigfileReader(bigfileMapping.data(), bigfileMapping.size());
+	BigfileIndex index;
 
 	try
 	{
-		initialiseVRM(std::format("{}.vrm", getFileNameWithoutExtension(inputFile, true)));
-		unsigned int bitshift;
-		reader.read((char*)&bitshift, sizeof(bitshift));
-		bitshift = ((bitshift >> 9) << 11) + 0x800;
-		reader.seekg(0, reader.end);
-		size_t filesize = reader.tellg();
-		reader.seekg(bitshift, reader.beg);
-	
-		std::ofstream tempWriter(tempFile.c_str(), std::ifstream::binary);
+		if (readBigfileIndex(bigfileReader, index) != 0)
+			return 1;
+	}
+	catch (std::out_of_range &e)
+	{
+		// End of stream exception
+		return 1;
+	}
+
+	if (listNamesBool && bigfilePairs.empty())
+	{
+		listBigfileEntries(index);
+		return 0;
+	}
+
+	for (const BigfilePair& pair : bigfilePairs)
+	{
+		std::string drmName = std::format("{:08X}", pair.drmHash);
+		const BigfileEntry* drmEntry = findBigfileEntry(index, pair.drmHash);
+		const BigfileEntry* vrmEntry = findBigfileEntry(index, pair.vrmHash);
+
+		if (drmEntry == nullptr || vrmEntry == nullptr)
+		{
+			std::cerr << std::format("Read Error: Bigfile has no entry with hash {:08X}", drmEntry == nullptr ? pair.drmHash : pair.vrmHash) << std::endl;
+			modelFailedToExport = true;
+			continue;
+		}
+
+		int drmReturnCode;
+
+		try
+		{
+			BinaryCursor drmReader = getBigfileEntryData(bigfileReader, *drmEntry);
+			BinaryCursor vrmReader = getBigfileEntryData(bigfileReader, *vrmEntry);
+
+			initialiseVRM(vrmReader.data(), vrmReader.size());
 
-		if (!tempWriter.is_open())
-			return 2;
+			std::cout << std::format("Reading from {} in {}...", drmName, inputFile) << std::endl;
 
-		while (reader.tellg() < filesize)
+			drmReturnCode = readDRM(drmReader, drmName, outputFolder + directorySeparator() + drmName, selectedModelExport, listNamesBool,
+				modelFailedToExport, textureFailedToExport, atLeastOneExportedSuccessfully);
+		}
+		catch (std::out_of_range &e)
+		{
+			drmReturnCode = 1;
+		}
+
+		if (drmReturnCode != 0)
 		{
-			unsigned char data;
-			reader.read((char*)&data, sizeof(data));
-			tempWriter << data;
+			// One bad entry should not stop the others from exporting
+			std::cerr << std::format("Read Error: End of stream while reading {}", drmName) << std::endl;
+			modelFailedToExport = true;
 		}
-		tempWriter.close();
+	}
 
-		reader.close();
-		reader.open(tempFile.c_str(), std::ifstream::binary);
+	return 0;
+}
 
-		if (!reader.is_open())
-			return 3;
+int readDRM(BinaryCursor drmReader, std::string drmName, std::string outputFolder, int selectedModelExport, bool listNamesBool,
+	bool& modelFailedToExport, bool& textureFailedToExport, bool& atLeastOneExportedSuccessfully)
+{
+	// Everything in the DRM is addressed relative to the end of its header
+	// Rather than copying the rest of the file somewhere else, the cursor's origin is just placed after the header
+	BinaryCursor reader;
+	unsigned int modelsAddressesStart;
+	BinaryCursor modelsAddressesReader;
+
+	try
+	{
+		unsigned int bitshift = drmReader.read<unsigned int>();
+		bitshift = ((bitshift >> 9) << 11) + 0x800;
+		if (bitshift > drmReader.size())
+			return 1;
 
-		std::cout << std::format("Reading from {}...", inputFile) << std::endl;
+		reader = drmReader.subspan(bitshift, drmReader.size() - bitshift);
 
-		reader.seekg(0x3C, reader.beg);
-		reader.read((char*)&modelsAddressesStart, sizeof(modelsAddressesStart));
-		reader.seekg(modelsAddressesStart, reader.beg);
+		modelsAddressesStart = reader.at(0x3C).read<unsigned int>();
+		modelsAddressesReader = reader.at(modelsAddressesStart);
 
 		if (listNamesBool)
 		{
 			// Break out of sequence entirely, only list names, do not export any models afterwards
-			int listNamesReturn = listNames(reader, modelsAddressesStart);
-			reader.close();
-			std::remove(tempFile.c_str());
-			return listNamesReturn;
+			return listNames(reader, modelsAddressesStart);
 		}
 	}
-	catch (std::ifstream::failure &e)
+	catch (std::out_of_range &e)
 	{
 		// End of stream exception
-		reader.close();
-		std::remove(tempFile.c_str());
 		return 1;
 	}
 
@@ -225,23 +448,18 @@ int readFile(std::ifstream& reader, std::string inputFile, std::string outputFol
 	while (selectedModelExport != 0)
 	{
 		unsigned int specificObjectAddress;
-		long int nextPos;
 		try
 		{
-			reader.read((char*)&specificObjectAddress, sizeof(specificObjectAddress));
+			specificObjectAddress = modelsAddressesReader.read<unsigned int>();
 
 			if (specificObjectAddress == modelsAddressesStart)
 				break;
 
 			objIndex++;
-
-			nextPos = reader.tellg();
 		}
-		catch (std::ifstream::failure &e)
+		catch (std::out_of_range &e)
 		{
 			// End of stream exception
-			reader.close();
-			std::remove(tempFile.c_str());
 			return 1;
 		}
 
@@ -256,25 +474,20 @@ int readFile(std::ifstream& reader, std::string inputFile, std::string outputFol
 
 			try
 			{
-				reader.seekg(specificObjectAddress + 0x24, reader.beg);
-				unsigned int objNameAddr;
-				reader.read((char*)&objNameAddr, sizeof(objNameAddr));
-				reader.seekg(objNameAddr, reader.beg);
+				unsigned int objNameAddr = reader.at(specificObjectAddress + 0x24).read<unsigned int>();
+				BinaryCursor objNameReader = reader.at(objNameAddr);
 				for (int i = 0; i < 8; i++)
 				{
-					char objNameChar;
-					reader.read((char*)&objNameChar, 1);
-					objName += objNameChar;
+					objName += objNameReader.read<char>();
 				}
 
-				reader.seekg(specificObjectAddress + 0x8, reader.beg);
-				reader.read((char*)&objectCount, sizeof(objectCount));
-				reader.seekg(2, reader.cur);
-				reader.read((char*)&objectStartAddress, sizeof(objectStartAddress));
+				BinaryCursor objectReader = reader.at(specificObjectAddress + 0x8);
+				objectCount = objectReader.read<unsigned short int>();
+				objectReader.skip(2);
+				objectStartAddress = objectReader.read<unsigned int>();
 			}
-			catch (std::ifstream::failure &e)
+			catch (std::out_of_range &e)
 			{
-				reader.seekg(nextPos, reader.beg);
 				std::cerr << std::format("Read Error: Error reading metadata of the model at index {}", objIndex) << std::endl;
 				continue;
 			}
@@ -293,16 +506,13 @@ int readFile(std::ifstream& reader, std::string inputFile, std::string outputFol
 
 				try
 				{
-					reader.seekg(objectStartAddress + (i * 4), reader.beg);
-					unsigned int objectModelData;
-					reader.read((char*)&objectModelData, sizeof(objectModelData));
+					unsigned int objectModelData = reader.at(objectStartAddress + (i * 4)).read<unsigned int>();
 
 					std::cout << std::format("	Reading {}...", objectNameAndIndex) << std::endl;
 
-					reader.seekg(objectModelData, reader.beg);
-					objectReturnCode = convertObjToDAE(reader, outputFolder, objectNameAndIndex, inputFile);
+					objectReturnCode = convertObjToDAE(reader.at(objectModelData), outputFolder, objectNameAndIndex);
 				}
-				catch (std::ifstream::failure &e)
+				catch (std::out_of_range &e)
 				{
 					objectReturnCode = 2;
 				}
@@ -324,23 +534,18 @@ int readFile(std::ifstream& reader, std::string inputFile, std::string outputFol
 			}
 			if (objIndex == selectedModelExport) { break; }
 		}
-
-		reader.seekg(nextPos, reader.beg);
 	}
 	if (selectedModelExport < 1)
 	{
 		int levelReturnCode;
-		std::cout << std::format("Reading level geometry model {}...", getFileNameWithoutExtension(inputFile, false)) << std::endl;
+		std::cout << std::format("Reading level geometry model {}...", drmName) << std::endl;
 		try
 		{
-			reader.seekg(0, reader.beg);
-			unsigned int levelData;
-			reader.read((char*)&levelData, sizeof(levelData));
-			reader.seekg(levelData, reader.beg);
+			unsigned int levelData = reader.at(0).read<unsigned int>();
 
-			levelReturnCode = convertLevelToDAE(reader, outputFolder, inputFile);
+			levelReturnCode = convertLevelToDAE(reader.at(levelData), outputFolder, drmName);
 		}
-		catch(std::ifstream::failure &e)
+		catch(std::out_of_range &e)
 		{
 			levelReturnCode = 2;
 		}
@@ -354,98 +559,94 @@ int readFile(std::ifstream& reader, std::string inputFile, std::string outputFol
 		if (levelReturnCode == 2)
 		{
 			// Model failed to export
-			std::cerr << std::format("	Export Error: Level geometry {} failed to export", getFileNameWithoutExtension(inputFile, false)) << std::endl;
+			std::cerr << std::format("	Export Error: Level geometry {} failed to export", drmName) << std::endl;
 			modelFailedToExport = true;
 		}
 		else
 		{
 			atLeastOneExportedSuccessfully = true;
-			std::cout << std::format("	Successfully exported level geometry {}", getFileNameWithoutExtension(inputFile, false)) << std::endl;
+			std::cout << std::format("	Successfully exported level geometry {}", drmName) << std::endl;
 		}
 	}
-	reader.close();
-	std::remove(tempFile.c_str());
-
 	return 0;
 }
 
 
 
 
-int convertObjToDAE(std::ifstream& reader, std::string outputFolder, std::string objectName, std::string inputFile)
+// Writes a model whose polygons and textures have been read in the chosen model format
+static int exportModel(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials)
 {
-	unsigned short int vertexCount;
-	unsigned int vertexStartAddress;
-	unsigned short int polygonCount;
-	unsigned int polygonStartAddress;
-	unsigned short int boneCount;
-	unsigned int boneStartAddress;
-	unsigned int textureAnimationsStartAddress;
-
-	reader.read((char*)&vertexCount, sizeof(vertexCount));
-	reader.seekg(2, reader.cur);
-	reader.read((char*)&vertexStartAddress, sizeof(vertexStartAddress));
-	reader.seekg(8, reader.cur);
-	reader.read((char*)&polygonCount, sizeof(polygonCount));
-	reader.seekg(2, reader.cur);
-	reader.read((char*)&polygonStartAddress, sizeof(polygonStartAddress));
-	reader.read((char*)&boneCount, sizeof(boneCount));
-	reader.seekg(2, reader.cur);
-	reader.read((char*)&boneStartAddress, sizeof(boneStartAddress));
-	reader.read((char*)&textureAnimationsStartAddress, sizeof(textureAnimationsStartAddress));
-
-	std::vector<Vertex> vertices;
-
-	readVertices(reader, vertexCount, vertexStartAddress, boneCount, boneStartAddress, true, vertices);
-
-	std::vector<PolygonStruct> polygons;
+	int exportReturn;
+	if (modelFormat == ModelFormat::GLB)
+		exportReturn = exportToGLB(outputFolder, objectName, modelMesh, materials);
+	else if (modelFormat == ModelFormat::OBJ)
+		exportReturn = exportToOBJ(outputFolder, objectName, modelMesh, materials);
+	else
+		exportReturn = exportToXML(outputFolder, objectName, modelMesh, materials);
+
+	clearEmbeddedTextures();
+	return exportReturn;
+}
+
+int convertObjToDAE(BinaryCursor reader, std::string outputFolder, std::string objectName)
+{
+	unsigned short int vertexCount = reader.read<unsigned short int>();
+	reader.skip(2);
+	unsigned int vertexStartAddress = reader.read<unsigned int>();
+	reader.skip(8);
+	unsigned short int polygonCount = reader.read<unsigned short int>();
+	reader.skip(2);
+	unsigned int polygonStartAddress = reader.read<unsigned int>();
+	unsigned short int boneCount = reader.read<unsigned short int>();
+	reader.skip(2);
+	unsigned int boneStartAddress = reader.read<unsigned int>();
+	unsigned int textureAnimationsStartAddress = reader.read<unsigned int>();
+
+	Mesh modelMesh;
+
+	readVertices(reader, vertexCount, vertexStartAddress, boneCount, boneStartAddress, true, modelMesh.vertices);
+
 	std::vector<Material> materials;
 
 	std::filesystem::create_directory(outputFolder);
 
-	readPolygons(reader, objectName, outputFolder, polygonCount, polygonStartAddress, textureAnimationsStartAddress, true, polygons, materials, vertices);
+	readPolygons(reader, objectName, outputFolder, polygonCount, polygonStartAddress, textureAnimationsStartAddress, true, modelMesh, materials);
+
+	int exportReturn = exportModel(outputFolder, objectName, modelMesh, materials);
 
-	int exportReturn = exportToXML(outputFolder, objectName, polygons, materials);
+	resetTextureArena();
 
 	return exportReturn;
 }
 
-int convertLevelToDAE(std::ifstream& reader, std::string outputFolder, std::string inputFile)
+int convertLevelToDAE(BinaryCursor reader, std::string outputFolder, std::string objectName)
 {
-	std::string objectName = getFileNameWithoutExtension(inputFile, false);
-	unsigned int BSPTreeStartAddress;
-	unsigned int vertexCount;
-	unsigned int polygonCount;
-	unsigned int vertexColourCount;
-	unsigned int vertexStartAddress;
-	unsigned int polygonStartAddress;
-	unsigned int vertexColourStartAddress;
-	unsigned int materialStartAddress;
-
-	reader.read((char*)&BSPTreeStartAddress, sizeof(BSPTreeStartAddress));
-	reader.seekg(0x14, reader.cur);
-	reader.read((char*)&vertexCount, sizeof(vertexCount));
-	reader.read((char*)&polygonCount, sizeof(polygonCount));
-	reader.read((char*)&vertexColourCount, sizeof(vertexColourCount));
-	reader.read((char*)&vertexStartAddress, sizeof(vertexStartAddress));
-	reader.read((char*)&polygonStartAddress, sizeof(polygonStartAddress));
-	reader.read((char*)&vertexColourStartAddress, sizeof(vertexColourStartAddress));
-	reader.read((char*)&materialStartAddress, sizeof(materialStartAddress));
-
-	std::vector<Vertex> vertices;
-
-	readVertices(reader, vertexCount, vertexStartAddress, NULL, NULL, false, vertices);
+	// The BSP tree, vertex colour count and vertex colour start address aren't used yet, so they're skipped over
+	reader.skip(4 + 0x14);
+	unsigned int vertexCount = reader.read<unsigned int>();
+	unsigned int polygonCount = reader.read<unsigned int>();
+	reader.skip(4);
+	unsigned int vertexStartAddress = reader.read<unsigned int>();
+	unsigned int polygonStartAddress = reader.read<unsigned int>();
+	reader.skip(4);
+	unsigned int materialStartAddress = reader.read<unsigned int>();
+
+	Mesh modelMesh;
+
+	readVertices(reader, vertexCount, vertexStartAddress, NULL, NULL, false, modelMesh.vertices);
 
 	// Read vertex colours
 
-	std::vector<PolygonStruct> polygons;
 	std::vector<Material> materials;
 
 	std::filesystem::create_directory(outputFolder);
 
-	readPolygons(reader, objectName, outputFolder, polygonCount, polygonStartAddress, materialStartAddress, false, polygons, materials, vertices);
+	readPolygons(reader, objectName, outputFolder, polygonCount, polygonStartAddress, materialStartAddress, false, modelMesh, materials);
+
+	int exportReturn = exportModel(outputFolder, objectName, modelMesh, materials);
 
-	int exportReturn = exportToXML(outputFolder, objectName, polygons, materials);
+	resetTextureArena();
 
 	return exportReturn;
 }
@@ -16,46 +16,38 @@
 
 #include "SharedFunctions.h"
 #include "Constants.h"
+#include "ModelNamesLister.h"
 
 #include <filesystem>
 
-int listNames(std::ifstream& reader, unsigned int modelsAddressesStart)
+int listNames(BinaryCursor reader, unsigned int modelsAddressesStart)
 {
-	reader.seekg(modelsAddressesStart, reader.beg);
+	BinaryCursor modelsAddressesReader = reader.at(modelsAddressesStart);
 
 	int nameIterator = 1;
 	while (true)
 	{
-		unsigned int specificObjectAddress;
-		reader.read((char*)&specificObjectAddress, sizeof(specificObjectAddress));
+		unsigned int specificObjectAddress = modelsAddressesReader.read<unsigned int>();
 
 		if (specificObjectAddress == modelsAddressesStart)
 		{
 			break;
 		}
 
-		long int nextPos = reader.tellg();
-
 		if (nameIterator == 8192)
 			break;
 
-		reader.seekg(specificObjectAddress + 0x24, reader.beg);
-		unsigned int objNameAddr;
-		reader.read((char*)&objNameAddr, sizeof(objNameAddr));
-		reader.seekg(objNameAddr, reader.beg);
+		unsigned int objNameAddr = reader.at(specificObjectAddress + 0x24).read<unsigned int>();
+		BinaryCursor objNameReader = reader.at(objNameAddr);
 		std::string objName;
 		for (int i = 0; i < 8; i++)
 		{
-			char objNameChar;
-			reader.read((char*)&objNameChar, 1);
-			objName += objNameChar;
+			objName += objNameReader.read<char>();
 		}
 
 		std::cout << nameIterator << ": " << objName << std::endl;
 
 		nameIterator++;
-
-		reader.seekg(nextPos, reader.beg);
 	}
 
 	std::cout << "Exit Code 0: Successful listing with no errors" << std::endl;
@@ -0,0 +1,112 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "NumberFormat.h"
+
+#include <charconv>
+#include <cstring>
+
+char* formatFixedPoint(char* buffer, int number, unsigned int powerOfTen)
+{
+	if (powerOfTen == 0)
+		return formatInteger(buffer, number);
+
+	// The digits are worked out from the magnitude, so that the sign only goes in front of the whole number
+	unsigned int magnitude = number;
+	if (number < 0)
+	{
+		*buffer++ = '-';
+		magnitude = 0u - magnitude;
+	}
+
+	char digits[16];
+	unsigned int digitCount = std::to_chars(digits, digits + sizeof(digits), magnitude).ptr - digits;
+
+	if (digitCount <= powerOfTen)
+	{
+		*buffer++ = '0';
+		*buffer++ = '.';
+		std::memset(buffer, '0', powerOfTen - digitCount);
+		buffer += powerOfTen - digitCount;
+		std::memcpy(buffer, digits, digitCount);
+		buffer += digitCount;
+	}
+	else
+	{
+		unsigned int wholeDigitCount = digitCount - powerOfTen;
+		std::memcpy(buffer, digits, wholeDigitCount);
+		buffer += wholeDigitCount;
+		*buffer++ = '.';
+		std::memcpy(buffer, digits + wholeDigitCount, powerOfTen);
+		buffer += powerOfTen;
+	}
+
+	// Trailing zeros of the fraction are removed, but a fraction that is all zeros is left as it is
+	char* fraction = buffer - powerOfTen;
+	char* lastNonZero = buffer - 1;
+	while (lastNonZero >= fraction && *lastNonZero == '0')
+		lastNonZero--;
+
+	if (lastNonZero >= fraction)
+		buffer = lastNonZero + 1;
+
+	return buffer;
+}
+
+char* formatInteger(char* buffer, long long int number)
+{
+	return std::to_chars(buffer, buffer + maxFormattedNumberLength, number).ptr;
+}
+
+char* formatFloat(char* buffer, float value)
+{
+	return std::to_chars(buffer, buffer + maxFormattedNumberLength, value).ptr;
+}
+
+char* formatFloatFixed(char* buffer, float value)
+{
+	return std::to_chars(buffer, buffer + maxFormattedNumberLength, (double)value, std::chars_format::fixed, 6).ptr;
+}
+
+char* formatFixedPoints(char* buffer, const int* numbers, size_t count, unsigned int powerOfTen)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		buffer = formatFixedPoint(buffer, numbers[i], powerOfTen);
+		*buffer++ = ' ';
+	}
+	return buffer;
+}
+
+char* formatIntegers(char* buffer, const int* numbers, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		buffer = formatInteger(buffer, numbers[i]);
+		*buffer++ = ' ';
+	}
+	return buffer;
+}
+
+char* formatFloats(char* buffer, const float* values, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		buffer = formatFloat(buffer, values[i]);
+		*buffer++ = ' ';
+	}
+	return buffer;
+}
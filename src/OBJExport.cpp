@@ -0,0 +1,189 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "OBJExport.h"
+#include "SharedFunctions.h"
+#include "TextureExporter.h"
+#include "TextureAtlas.h"
+#include "NumberFormat.h"
+#include "BufferedFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <unordered_map>
+
+// Only real materials that exported properly have a texture, the rest are just their colour
+static bool materialHasTexture(const Material& material)
+{
+	return material.realMaterial && material.properlyExported;
+}
+
+static bool exportMTL(std::string path, std::string objectName, std::vector<Material>& materials)
+{
+	BufferedFile mtl;
+	if (!mtl.open(path))
+		return false;
+
+	mtl.write("# Gex 2 PS1 Model Exporter\n");
+
+	for (unsigned int m = 0; m < materials.size(); m++)
+	{
+		const Material& material = materials[m];
+
+		mtl.write(std::format("\nnewmtl {}-mat{}\n", objectName, m));
+
+		// Real materials never have their colour read in, so they're white and take their colour from the texture
+		// Fake materials have the same colour as in the .dae
+		float colour[3] = { 1.0f, 1.0f, 1.0f };
+		if (!material.realMaterial)
+		{
+			colour[0] = rgbToLinearRgb(material.redVal) / 1.25f;
+			colour[1] = rgbToLinearRgb(material.greenVal) / 1.25f;
+			colour[2] = rgbToLinearRgb(material.blueVal) / 1.25f;
+		}
+
+		char* colourText = mtl.beginInPlace(3 * (maxFormattedNumberLength + 1) + 4);
+		std::memcpy(colourText, "Kd ", 3);
+		colourText += 3;
+		for (float component : colour)
+		{
+			colourText = formatFloatFixed(colourText, component);
+			*colourText++ = ' ';
+		}
+		colourText[-1] = '\n';
+		mtl.endInPlace(colourText);
+
+		mtl.write("Ks 0.000000 0.000000 0.000000\nd 1\nillum 1\n");
+
+		if (materialHasTexture(material))
+		{
+			std::string textureFileName = textureAtlasEnabled() ? textureAtlasFileName(objectName)
+				: std::format("{}-tex{}.{}", objectName, material.textureID + 1, textureImageExtension());
+			mtl.write(std::format("map_Kd {}\n", textureFileName));
+		}
+	}
+
+	return mtl.close();
+}
+
+int exportToOBJ(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials)
+{
+	int returnValue = 0;
+
+	if (!std::filesystem::exists(outputFolder))
+		return 2;
+
+	std::string path = std::format("{}{}{}", outputFolder, directorySeparator(), objectName);
+
+	if (!exportMTL(path + ".mtl", objectName, materials))
+		return 2;
+
+	BufferedFile obj;
+	if (!obj.open(path + ".obj"))
+		return 2;
+
+	obj.write(std::format("# Gex 2 PS1 Model Exporter\nmtllib {}.mtl\no {}\n", objectName, objectName));
+
+	// Positions are in thousandths, written out as fixed point so they don't pick up float rounding errors
+	// The .dae is Z up and OBJ is Y up, so Y and Z swap, with Z negated to keep it right handed
+	for (const Vertex& vertex : modelMesh.vertices)
+	{
+		char* positionText = obj.beginInPlace(3 * (maxFormattedNumberLength + 1) + 2);
+		*positionText++ = 'v';
+		for (int coordinate : { (int)vertex.finalX, (int)vertex.finalZ, -(int)vertex.finalY })
+		{
+			*positionText++ = ' ';
+			positionText = formatFixedPoint(positionText, coordinate, 3);
+		}
+		*positionText++ = '\n';
+		obj.endInPlace(positionText);
+	}
+
+	// Each distinct UV is written once, just before the first material that uses it, keyed by the bits of its U and V
+	std::unordered_map<unsigned long long int, unsigned int> UVIDs;
+	std::vector<unsigned int> cornerUVIDs;
+
+	for (unsigned int m = 0; m < materials.size(); m++)
+	{
+		const Material& material = materials[m];
+
+		if (!material.properlyExported)
+			returnValue = 1;
+
+		if (material.polygonCount == 0)
+			continue;
+
+		bool hasTexture = materialHasTexture(material);
+		cornerUVIDs.clear();
+
+		if (hasTexture)
+		{
+			for (unsigned int c = material.polygonStart * 3; c < (material.polygonStart + material.polygonCount) * 3; c++)
+			{
+				unsigned int u, v;
+				std::memcpy(&u, &modelMesh.UVs[c].u, sizeof(u));
+				std::memcpy(&v, &modelMesh.UVs[c].v, sizeof(v));
+
+				auto [UVID, isNew] = UVIDs.emplace(((unsigned long long int)u << 32) | v, (unsigned int)UVIDs.size() + 1);
+				if (isNew)
+				{
+					char* UVText = obj.beginInPlace(2 * (maxFormattedNumberLength + 1) + 3);
+					std::memcpy(UVText, "vt", 2);
+					UVText += 2;
+					for (float coordinate : { modelMesh.UVs[c].u, modelMesh.UVs[c].v })
+					{
+						*UVText++ = ' ';
+						UVText = formatFloat(UVText, coordinate);
+					}
+					*UVText++ = '\n';
+					obj.endInPlace(UVText);
+				}
+				cornerUVIDs.push_back(UVID->second);
+			}
+		}
+
+		obj.write(std::format("usemtl {}-mat{}\n", objectName, m));
+
+		// OBJ indices start from 1
+		for (unsigned int p = 0; p < material.polygonCount; p++)
+		{
+			const PolygonStruct& polygon = modelMesh.polygons[material.polygonStart + p];
+
+			char* faceText = obj.beginInPlace(3 * (2 * maxFormattedNumberLength + 2) + 2);
+			*faceText++ = 'f';
+			unsigned int c = 0;
+			for (unsigned short int vertexID : { polygon.v1, polygon.v2, polygon.v3 })
+			{
+				*faceText++ = ' ';
+				faceText = formatInteger(faceText, vertexID + 1);
+				if (hasTexture)
+				{
+					*faceText++ = '/';
+					faceText = formatInteger(faceText, cornerUVIDs[(p * 3) + c]);
+				}
+				c++;
+			}
+			*faceText++ = '\n';
+			obj.endInPlace(faceText);
+		}
+	}
+
+	if (!obj.close())
+		return 2;
+
+	return returnValue;
+}
@@ -16,16 +16,18 @@
 
 #include "PolygonsInterpreter.h"
 #include "TextureExporter.h"
+#include "UVKernels.h"
+#include "TextureAtlas.h"
+#include "SpriteSheet.h"
 
 #include <cmath>
-#include <fstream>
+#include <iostream>
 #include <string>
 #include <format>
-#include <algorithm>
 
-void readPolygons(std::ifstream& reader, std::string objectName, std::string outputFolder, unsigned short int polygonCount,
-    unsigned int polygonStartAddress, unsigned int textureAnimationsStartAddress, bool isObject, std::vector<PolygonStruct>& polygons,
-    std::vector<Material>& materials, std::vector<Vertex>& vertices)
+void readPolygons(BinaryCursor reader, std::string objectName, std::string outputFolder, unsigned short int polygonCount,
+    unsigned int polygonStartAddress, unsigned int textureAnimationsStartAddress, bool isObject, Mesh& modelMesh,
+    std::vector<Material>& materials)
 {
 	if (polygonStartAddress == 0 || polygonCount == 0) { return; }
 
@@ -40,72 +42,134 @@ void readPolygons(std::ifstream& reader, std::string objectName, std::string out
 			levelSubframes = readLevelAnimationSubFrames(reader, textureAnimationsStartAddress);
 	}
 
-	reader.seekg(polygonStartAddress, reader.beg);
+	MaterialLookup materialLookup;
+
+	for (unsigned int i = 0; i < objectSubframes.size(); i++)
+	{
+		materialLookup.subframeIDsByMaterialAddress[objectSubframes[i].baseMaterialAddress].push_back(i);
+		materialLookup.subframeIDsByClutAndPage[(objectSubframes[i].texturePage << 16) | objectSubframes[i].clutValue].push_back(i);
+	}
+
+	unsigned int polygonSize = isObject ? 0xC : 0x14;
+
+	modelMesh.polygons.reserve(polygonCount);
+	modelMesh.UVs.resize(polygonCount * 3);
 
 	for (unsigned short int p = 0; p < polygonCount; p++)
 	{
-		unsigned int uPolygonPosition = reader.tellg();
-		polygons.push_back(readPolygon(reader, p, textureAnimationsStartAddress, isObject, materials, vertices, objectSubframes));
-		if (isObject) reader.seekg(uPolygonPosition + 0xC, reader.beg);
-		else reader.seekg(uPolygonPosition + 0x14, reader.beg);
+		modelMesh.polygons.push_back(readPolygon(reader.at(polygonStartAddress + (p * polygonSize)), p, textureAnimationsStartAddress, isObject,
+			&modelMesh.UVs[p * 3], materials, materialLookup, modelMesh.vertices, objectSubframes));
 	}
 
+	groupPolygonsByMaterial(modelMesh, materials);
+
+	clearTextureAtlas();
+
 	for (unsigned int m = 0; m < materials.size(); m++)
 	{
 		if (materials[m].realMaterial)
 		{
-			materials[m].properlyExported = UVPointCorrectionAndExport(m, isObject, objectName, outputFolder, materials[m], polygons, !isObject, levelSubframes);
+			materials[m].properlyExported = UVPointCorrectionAndExport(m, isObject, objectName, outputFolder, materials[m], modelMesh, !isObject, levelSubframes);
 
 			for (unsigned int i = 0; i < materials[m].objectSubframes.size(); i++)
 			{
 				objectSubframePointCorrectionAndExport(m, materials[m].textureID, objectName, outputFolder, materials[m].objectSubframes[i]);
 			}
+
+			if (spriteSheetsEnabled() && !exportSpriteSheet(objectName, outputFolder, materials[m].textureID + 1))
+			{
+				std::cerr << std::format("	Export Error: Sprite sheet {}-tex{}-frames.{} failed to export",
+					objectName, (materials[m].textureID + 1), textureImageExtension()) << std::endl;
+			}
+		}
+	}
+
+	if (textureAtlasEnabled() && !exportTextureAtlas(objectName, outputFolder, modelMesh, materials))
+	{
+		std::cerr << std::format("	Export Error: Texture atlas {} failed to export", textureAtlasFileName(objectName)) << std::endl;
+
+		for (unsigned int m = 0; m < materials.size(); m++)
+		{
+			if (materials[m].realMaterial)
+				materials[m].properlyExported = false;
 		}
 	}
 }
 
-std::vector<ObjectAnimationSubframe> readObjectAnimationSubFrames(std::ifstream& reader, unsigned int textureAnimationsStartAddress)
+void groupPolygonsByMaterial(Mesh& modelMesh, std::vector<Material>& materials)
+{
+	// Counting sort of the polygons (and their UVs) by material ID
+	// It is stable, so each material's polygons keep the order they were read in
+	for (Material& material : materials)
+	{
+		material.polygonStart = 0;
+		material.polygonCount = 0;
+	}
+
+	for (const PolygonStruct& polygon : modelMesh.polygons)
+		materials[polygon.materialID].polygonCount++;
+
+	unsigned int polygonStart = 0;
+	for (Material& material : materials)
+	{
+		material.polygonStart = polygonStart;
+		polygonStart += material.polygonCount;
+	}
+
+	std::vector<unsigned int> nextPolygonIDs(materials.size());
+	for (unsigned int m = 0; m < materials.size(); m++)
+		nextPolygonIDs[m] = materials[m].polygonStart;
+
+	std::vector<PolygonStruct> groupedPolygons(modelMesh.polygons.size());
+	std::vector<UV> groupedUVs(modelMesh.UVs.size());
+
+	for (unsigned int p = 0; p < modelMesh.polygons.size(); p++)
+	{
+		unsigned int groupedID = nextPolygonIDs[modelMesh.polygons[p].materialID]++;
+		groupedPolygons[groupedID] = modelMesh.polygons[p];
+		groupedUVs[groupedID * 3] = modelMesh.UVs[p * 3];
+		groupedUVs[(groupedID * 3) + 1] = modelMesh.UVs[(p * 3) + 1];
+		groupedUVs[(groupedID * 3) + 2] = modelMesh.UVs[(p * 3) + 2];
+	}
+
+	modelMesh.polygons.swap(groupedPolygons);
+	modelMesh.UVs.swap(groupedUVs);
+}
+
+std::vector<ObjectAnimationSubframe> readObjectAnimationSubFrames(BinaryCursor reader, unsigned int textureAnimationsStartAddress)
 {
 	std::vector<ObjectAnimationSubframe> objectSubframes;
 
-	reader.seekg(textureAnimationsStartAddress, reader.beg);
-	unsigned int textureAnimationsCount;
-	reader.read((char*)&textureAnimationsCount, sizeof(textureAnimationsCount));
+	unsigned int textureAnimationsCount = reader.at(textureAnimationsStartAddress).read<unsigned int>();
 	for (int i = 0; i < textureAnimationsCount; i++)
 	{
-		unsigned int uTextureAnimationsPosition = reader.tellg();
-		unsigned int materialAddress;
-		unsigned int subframesCount;
-		reader.read((char*)&materialAddress, sizeof(materialAddress));
-		reader.read((char*)&subframesCount, sizeof(subframesCount));
-		reader.seekg(materialAddress + 0x10, reader.beg);
+		BinaryCursor textureAnimationReader = reader.at(textureAnimationsStartAddress + 4 + (i * 0xC));
+		unsigned int materialAddress = textureAnimationReader.read<unsigned int>();
+		unsigned int subframesCount = textureAnimationReader.read<unsigned int>();
 		for (int m = 0; m < subframesCount; m++)
 		{
-			unsigned int uSubframePosition = reader.tellg();
-			objectSubframes.push_back(readObjectAnimationSubFrame(reader, materialAddress));
+			objectSubframes.push_back(readObjectAnimationSubFrame(reader.at(materialAddress + 0x10 + (m * 0x10)), materialAddress));
 			objectSubframes[objectSubframes.size() - 1].subframeID = m;
-			reader.seekg(uSubframePosition + 0x10, reader.beg);
 		}
-		reader.seekg(uTextureAnimationsPosition + 0xC, reader.beg);
 	}
 
 	return objectSubframes;
 }
 
-ObjectAnimationSubframe readObjectAnimationSubFrame(std::ifstream &reader, unsigned int baseMaterialAddress)
+ObjectAnimationSubframe readObjectAnimationSubFrame(BinaryCursor reader, unsigned int baseMaterialAddress)
 {
 	ObjectAnimationSubframe subframe;
 
 	unsigned char u[3];
 	unsigned char v[3];
-	reader.read((char*)&u[0], 1);
-	reader.read((char*)&v[0], 1);
-	reader.read((char*)&subframe.clutValue, sizeof(subframe.clutValue));
-	reader.read((char*)&u[1], 1);
-	reader.read((char*)&v[1], 1);
-	reader.read((char*)&subframe.texturePage, sizeof(subframe.texturePage));
-	reader.read((char*)&u[2], 1);
-	reader.read((char*)&v[2], 1);
+	u[0] = reader.read<unsigned char>();
+	v[0] = reader.read<unsigned char>();
+	subframe.clutValue = reader.read<unsigned short int>();
+	u[1] = reader.read<unsigned char>();
+	v[1] = reader.read<unsigned char>();
+	subframe.texturePage = reader.read<unsigned short int>();
+	u[2] = reader.read<unsigned char>();
+	v[2] = reader.read<unsigned char>();
 
 	subframe.UVs.push_back({ u[0] / 255.0f, (255 - v[0]) / 255.0f });
 	subframe.UVs.push_back({ u[1] / 255.0f, (255 - v[1]) / 255.0f });
@@ -116,59 +180,49 @@ ObjectAnimationSubframe readObjectAnimationSubFrame(std::ifstream &reader, unsig
 	return subframe;
 }
 
-std::vector<LevelAnimationSubframe> readLevelAnimationSubFrames(std::ifstream& reader, unsigned int textureAnimationsStartAddress)
+std::vector<LevelAnimationSubframe> readLevelAnimationSubFrames(BinaryCursor reader, unsigned int textureAnimationsStartAddress)
 {
 	std::vector<LevelAnimationSubframe> levelSubframes;
 
-	reader.seekg(textureAnimationsStartAddress, reader.beg);
-	unsigned int textureAnimationsCount;
-	reader.read((char*)&textureAnimationsCount, sizeof(textureAnimationsCount));
+	BinaryCursor textureAnimationsReader = reader.at(textureAnimationsStartAddress);
+	unsigned int textureAnimationsCount = textureAnimationsReader.read<unsigned int>();
 	for (unsigned int i = 0; i < textureAnimationsCount; i++)
 	{
-		unsigned int uTextureAnimationsPosition = reader.tellg();
-		unsigned int materialAddress;
-		reader.read((char*)&materialAddress, sizeof(materialAddress));
-		reader.seekg(materialAddress, reader.beg);
-		LevelAnimationSubframe* subframesPointer = readLevelAnimationSubFrame(reader, materialAddress);
-		levelSubframes.push_back(subframesPointer[0]);
-		levelSubframes.push_back(subframesPointer[1]);
-		reader.seekg(uTextureAnimationsPosition + 4, reader.beg);
+		unsigned int materialAddress = textureAnimationsReader.read<unsigned int>();
+		readLevelAnimationSubFrame(reader.at(materialAddress), materialAddress, levelSubframes);
 	}
 
 	return levelSubframes;
 }
 
-LevelAnimationSubframe* readLevelAnimationSubFrame(std::ifstream &reader, unsigned int baseMaterialAddress)
+void readLevelAnimationSubFrame(BinaryCursor reader, unsigned int baseMaterialAddress, std::vector<LevelAnimationSubframe>& levelSubframes)
 {
-	LevelAnimationSubframe* subframes = new LevelAnimationSubframe[2];
+	LevelAnimationSubframe subframes[2];
 
-	reader.read((char*)&(subframes[0].xCoordinateDestination), sizeof(subframes[0].xCoordinateDestination));
-	reader.read((char*)&(subframes[0].yCoordinateDestination), sizeof(subframes[0].yCoordinateDestination));
-	reader.read((char*)&(subframes[0].xSize), sizeof(subframes[0].xSize));
-	reader.read((char*)&(subframes[0].ySize), sizeof(subframes[0].ySize));
+	subframes[0].xCoordinateDestination = reader.read<unsigned short int>();
+	subframes[0].yCoordinateDestination = reader.read<unsigned short int>();
+	subframes[0].xSize = reader.read<unsigned short int>();
+	subframes[0].ySize = reader.read<unsigned short int>();
 
-	reader.read((char*)&(subframes[1].xCoordinateDestination), sizeof(subframes[1].xCoordinateDestination));
-	reader.read((char*)&(subframes[1].yCoordinateDestination), sizeof(subframes[1].yCoordinateDestination));
-	reader.read((char*)&(subframes[1].xSize), sizeof(subframes[1].xSize));
-	reader.read((char*)&(subframes[1].ySize), sizeof(subframes[1].ySize));
+	subframes[1].xCoordinateDestination = reader.read<unsigned short int>();
+	subframes[1].yCoordinateDestination = reader.read<unsigned short int>();
+	subframes[1].xSize = reader.read<unsigned short int>();
+	subframes[1].ySize = reader.read<unsigned short int>();
 
 	subframes[0].xCoordinateDestination -= 0x200;
 	subframes[1].xCoordinateDestination -= 0x200;
 
-	reader.seekg(8, reader.cur);
+	reader.skip(8);
 
-	unsigned int numberOfFrames;
-	reader.read((char*)&numberOfFrames, sizeof(numberOfFrames));
-	reader.seekg(4, reader.cur);
+	unsigned int numberOfFrames = reader.read<unsigned int>();
+	reader.skip(4);
 
 	for (unsigned int frame = 0; frame < numberOfFrames; frame++)
 	{
-		unsigned short int xCoordinateSource1, yCoordinateSource1, xCoordinateSource2, yCoordinateSource2;
-
-		reader.read((char*)&xCoordinateSource1, sizeof(xCoordinateSource1));
-		reader.read((char*)&yCoordinateSource1, sizeof(yCoordinateSource1));
-		reader.read((char*)&xCoordinateSource2, sizeof(xCoordinateSource2));
-		reader.read((char*)&yCoordinateSource2, sizeof(yCoordinateSource2));
+		unsigned short int xCoordinateSource1 = reader.read<unsigned short int>();
+		unsigned short int yCoordinateSource1 = reader.read<unsigned short int>();
+		unsigned short int xCoordinateSource2 = reader.read<unsigned short int>();
+		unsigned short int yCoordinateSource2 = reader.read<unsigned short int>();
 
 		xCoordinateSource1 -= 0x200;
 		xCoordinateSource2 -= 0x200;
@@ -182,25 +236,26 @@ LevelAnimationSubframe* readLevelAnimationSubFrame(std::ifstream &reader, unsign
 	subframes[0].subframeExportsThis = false;
 	subframes[1].subframeExportsThis = false;
 
-	return subframes;
+	levelSubframes.push_back(std::move(subframes[0]));
+	levelSubframes.push_back(std::move(subframes[1]));
 }
 
-PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialStartAddress, bool isObject,
-    std::vector<Material>& materials, std::vector<Vertex>& vertices, std::vector<ObjectAnimationSubframe>& subframes)
+PolygonStruct readPolygon(BinaryCursor reader, unsigned int p, int materialStartAddress, bool isObject, UV* polygonUVs,
+    std::vector<Material>& materials, MaterialLookup& materialLookup, std::vector<Vertex>& vertices, std::vector<ObjectAnimationSubframe>& subframes)
 {
 	PolygonStruct thisPolygon;
 
-	unsigned short int v1Index;
-	unsigned short int v2Index;
-	unsigned short int v3Index;
+	unsigned short int v1Index = reader.read<unsigned short int>();
+	unsigned short int v2Index = reader.read<unsigned short int>();
+	unsigned short int v3Index = reader.read<unsigned short int>();
 
-	reader.read((char*)&v1Index, 2);
-	reader.read((char*)&v2Index, 2);
-	reader.read((char*)&v3Index, 2);
+	// Only the indices are kept, so they are checked here rather than letting a bad one through to the exporter
+	if (v1Index >= vertices.size() || v2Index >= vertices.size() || v3Index >= vertices.size())
+		throw std::out_of_range("Polygon refers to a vertex that does not exist");
 
-	thisPolygon.v1 = vertices[v1Index];
-	thisPolygon.v2 = vertices[v2Index];
-	thisPolygon.v3 = vertices[v3Index];
+	thisPolygon.v1 = v1Index;
+	thisPolygon.v2 = v2Index;
+	thisPolygon.v3 = v3Index;
 
 	Material thisMaterial;
 	bool realMaterial = true;
@@ -208,46 +263,21 @@ PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialSta
 	unsigned int materialAddress;
 
 	if (isObject)
-		readObjectPolygon(reader, thisPolygon, thisMaterial, realMaterial, materialAddress);
+		readObjectPolygon(reader, polygonUVs, thisMaterial, realMaterial, materialAddress);
 	else
-		readLevelPolygon(reader, thisPolygon, thisMaterial, realMaterial, materialAddress);
+		readLevelPolygon(reader, polygonUVs, thisMaterial, realMaterial, materialAddress);
 
 
 	if (realMaterial)
 	{
-		bool newMaterial = true;
-		for (int m = 0; m < materials.size(); m++)
-		{
-			bool newClutValue = true;
-			bool newTexturePage = true;
-			if (thisMaterial.clutValue == materials[m].clutValue)
-			{
-				newClutValue = false;
-			}
-			if (thisMaterial.texturePage == materials[m].texturePage)
-			{
-				newTexturePage = false;
-			}
-
-			if (!newClutValue && !newTexturePage)
-			{
-				newMaterial = false;
-				thisPolygon.materialID = m;
-				break;
-			}
-		}
+		unsigned int materialKey = (thisMaterial.texturePage << 16) | thisMaterial.clutValue;
+		auto existingMaterial = materialLookup.realMaterialIDs.find(materialKey);
 
-		if (newMaterial)
+		if (existingMaterial != materialLookup.realMaterialIDs.end())
+			thisPolygon.materialID = existingMaterial->second;
+		else
 		{
-			unsigned int textureCount = 0;
-			for (unsigned int i = 0; i < materials.size(); i++)
-			{
-				if (materials[i].realMaterial)
-				{
-					textureCount++;
-				}
-			}
-			thisMaterial.textureID = textureCount;
+			thisMaterial.textureID = materialLookup.textureCount++;
 
 			if (isObject)
 			{
@@ -255,9 +285,10 @@ PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialSta
 				unsigned int subframeIncrement = 0;
 				int subframeClutValue = -1;
 				int subframeTexturePage = -1;
-				for (unsigned int i = 0; i < subframes.size(); i++)
+				auto materialSubframes = materialLookup.subframeIDsByMaterialAddress.find(materialAddress);
+				if (materialSubframes != materialLookup.subframeIDsByMaterialAddress.end())
 				{
-					if (subframes[i].baseMaterialAddress == materialAddress)
+					for (const unsigned int& i : materialSubframes->second)
 					{
 						subframes[i].subframeID = subframeIncrement;
 						thisMaterial.objectSubframes.push_back(subframes[i]);
@@ -271,13 +302,17 @@ PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialSta
 				}
 
 				// Find all subframes with same CLUT and texture page, and add the UVs to the material subframes
-				for (unsigned int i = 0; i < subframes.size(); i++)
+				auto matchingSubframes = materialLookup.subframeIDsByClutAndPage.find((subframeTexturePage << 16) | subframeClutValue);
+				if (subframeClutValue != -1 && matchingSubframes != materialLookup.subframeIDsByClutAndPage.end())
 				{
-					if (subframes[i].subframeID == 0 && subframes[i].clutValue == subframeClutValue && subframes[i].texturePage == subframeTexturePage && subframes[i].baseMaterialAddress != materialAddress)
+					for (const unsigned int& i : matchingSubframes->second)
 					{
-						for (unsigned int j = 0; j < subframeIncrement * 3; j++)
+						if (subframes[i].subframeID == 0 && subframes[i].baseMaterialAddress != materialAddress)
 						{
-							thisMaterial.objectSubframes[j / 3].UVs.push_back(subframes[i + (j / 3)].UVs[j % 3]);
+							for (unsigned int j = 0; j < subframeIncrement * 3; j++)
+							{
+								thisMaterial.objectSubframes[j / 3].UVs.push_back(subframes[i + (j / 3)].UVs[j % 3]);
+							}
 						}
 					}
 				}
@@ -285,123 +320,112 @@ PolygonStruct readPolygon(std::ifstream& reader, unsigned int p, int materialSta
 
 			materials.push_back(thisMaterial);
 			thisPolygon.materialID = materials.size() - 1;
+			materialLookup.realMaterialIDs.emplace(materialKey, thisPolygon.materialID);
 		}
 	}
 	else
 	{
 		// For "fake materials", AKA polygons that don't actually have any materials that point to them in the files
-		bool newMaterial = true;
-		for (int m = 0; m < materials.size(); m++)
-		{
-			if (!materials[m].realMaterial && thisMaterial.redVal == materials[m].redVal
-			&& thisMaterial.greenVal == materials[m].greenVal && thisMaterial.blueVal == materials[m].blueVal)
-			{
-				newMaterial = false;
-				thisPolygon.materialID = m;
-				break;
-			}
-		}
-		if (newMaterial)
+		unsigned int colourKey = (thisMaterial.redVal << 16) | (thisMaterial.greenVal << 8) | thisMaterial.blueVal;
+		auto existingMaterial = materialLookup.fakeMaterialIDs.find(colourKey);
+
+		if (existingMaterial != materialLookup.fakeMaterialIDs.end())
+			thisPolygon.materialID = existingMaterial->second;
+		else
 		{
 			thisMaterial.realMaterial = false;
 			thisMaterial.visible = true;
 			thisMaterial.properlyExported = true;
 			materials.push_back(thisMaterial);
 			thisPolygon.materialID = materials.size() - 1;
+			materialLookup.fakeMaterialIDs.emplace(colourKey, thisPolygon.materialID);
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			polygonUVs[c].u = 0.0f;
+			polygonUVs[c].v = 255.0f;
 		}
-		thisPolygon.uv1.u = 0.0f;
-		thisPolygon.uv2.u = 0.0f;
-		thisPolygon.uv3.u = 0.0f;
-		thisPolygon.uv1.v = 255.0f;
-		thisPolygon.uv2.v = 255.0f;
-		thisPolygon.uv3.v = 255.0f;
 	}
 
 	return thisPolygon;
 }
 
-void readObjectPolygon(std::ifstream& reader, PolygonStruct& thisPolygon, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress)
+void readObjectPolygon(BinaryCursor& reader, UV* polygonUVs, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress)
 {
-	reader.seekg(1, reader.cur);
+	reader.skip(1);
 
-	unsigned char polygonFlags;
-	reader.read((char*)&polygonFlags, sizeof(polygonFlags));
+	unsigned char polygonFlags = reader.read<unsigned char>();
 	thisMaterial.visible = true;
 
 	if ((polygonFlags & 0x02) == 0x02)
 	{
 		realMaterial = true;
-		reader.read((char*)&materialAddress, sizeof(materialAddress));
+		materialAddress = reader.read<unsigned int>();
 
-		reader.seekg(materialAddress, reader.beg);
+		BinaryCursor materialReader = reader.at(materialAddress);
 
 		unsigned char u[3];
 		unsigned char v[3];
-		reader.read((char*)&u[0], 1);
-		reader.read((char*)&v[0], 1);
-		reader.seekg(2, reader.cur);
-		reader.read((char*)&u[1], 1);
-		reader.read((char*)&v[1], 1);
-		reader.seekg(2, reader.cur);
-		reader.read((char*)&u[2], 1);
-		reader.read((char*)&v[2], 1);
-
-		thisPolygon.uv1.u = u[0] / 255.0f;
-		thisPolygon.uv1.v = (255 - v[0]) / 255.0f;
-		thisPolygon.uv2.u = u[1] / 255.0f;
-		thisPolygon.uv2.v = (255 - v[1]) / 255.0f;
-		thisPolygon.uv3.u = u[2] / 255.0f;
-		thisPolygon.uv3.v = (255 - v[2]) / 255.0f;
-
-		reader.seekg(materialAddress, reader.beg);
-		thisMaterial = readMaterial(reader);
+		u[0] = materialReader.read<unsigned char>();
+		v[0] = materialReader.read<unsigned char>();
+		materialReader.skip(2);
+		u[1] = materialReader.read<unsigned char>();
+		v[1] = materialReader.read<unsigned char>();
+		materialReader.skip(2);
+		u[2] = materialReader.read<unsigned char>();
+		v[2] = materialReader.read<unsigned char>();
+
+		for (int c = 0; c < 3; c++)
+		{
+			polygonUVs[c].u = u[c] / 255.0f;
+			polygonUVs[c].v = (255 - v[c]) / 255.0f;
+		}
+
+		thisMaterial = readMaterial(reader.at(materialAddress));
 	}
 	else
 	{
 		// For "fake materials", AKA polygons that don't actually have any materials that point to them in the files
 		realMaterial = false;
 
-		reader.read((char*)&thisMaterial.redVal, 1);
-		reader.read((char*)&thisMaterial.greenVal, 1);
-		reader.read((char*)&thisMaterial.blueVal, 1);
+		thisMaterial.redVal = reader.read<unsigned char>();
+		thisMaterial.greenVal = reader.read<unsigned char>();
+		thisMaterial.blueVal = reader.read<unsigned char>();
 	}
 }
 
-void readLevelPolygon(std::ifstream& reader, PolygonStruct& thisPolygon, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress)
+void readLevelPolygon(BinaryCursor& reader, UV* polygonUVs, Material& thisMaterial, bool& realMaterial, unsigned int& materialAddress)
 {
-	unsigned char polygonFlags;
-	reader.seekg(0x1, reader.cur);
-	reader.read((char*)&polygonFlags, sizeof(polygonFlags));
-	reader.seekg(0x8, reader.cur);
+	reader.skip(1);
+	unsigned char polygonFlags = reader.read<unsigned char>();
+	reader.skip(8);
 
-	reader.read((char*)&materialAddress, sizeof(materialAddress));
+	materialAddress = reader.read<unsigned int>();
 
 	// 0x02 = Animated texture flag
 	// 0x80 = Invisible texture flag
 	if (materialAddress != 0xFFFF && (polygonFlags & 0x80) != 0x80)
 	{
-		reader.seekg(materialAddress, reader.beg);
+		BinaryCursor materialReader = reader.at(materialAddress);
 
 		unsigned char u[3];
 		unsigned char v[3];
-		reader.read((char*)&u[0], 1);
-		reader.read((char*)&v[0], 1);
-		reader.seekg(2, reader.cur);
-		reader.read((char*)&u[1], 1);
-		reader.read((char*)&v[1], 1);
-		reader.seekg(2, reader.cur);
-		reader.read((char*)&u[2], 1);
-		reader.read((char*)&v[2], 1);
-
-		thisPolygon.uv1.u = u[0] / 255.0f;
-		thisPolygon.uv1.v = (255 - v[0]) / 255.0f;
-		thisPolygon.uv2.u = u[1] / 255.0f;
-		thisPolygon.uv2.v = (255 - v[1]) / 255.0f;
-		thisPolygon.uv3.u = u[2] / 255.0f;
-		thisPolygon.uv3.v = (255 - v[2]) / 255.0f;
-
-		reader.seekg(materialAddress, reader.beg);
-		thisMaterial = readMaterial(reader);
+		u[0] = materialReader.read<unsigned char>();
+		v[0] = materialReader.read<unsigned char>();
+		materialReader.skip(2);
+		u[1] = materialReader.read<unsigned char>();
+		v[1] = materialReader.read<unsigned char>();
+		materialReader.skip(2);
+		u[2] = materialReader.read<unsigned char>();
+		v[2] = materialReader.read<unsigned char>();
+
+		for (int c = 0; c < 3; c++)
+		{
+			polygonUVs[c].u = u[c] / 255.0f;
+			polygonUVs[c].v = (255 - v[c]) / 255.0f;
+		}
+
+		thisMaterial = readMaterial(reader.at(materialAddress));
 	}
 	else
 		realMaterial = false;
@@ -410,72 +434,34 @@ void readLevelPolygon(std::ifstream& reader, PolygonStruct& thisPolygon, Materia
 
 
 
-Material readMaterial(std::ifstream& reader)
+Material readMaterial(BinaryCursor reader)
 {
 	Material thisMaterial;
 	thisMaterial.realMaterial = true;
 
-	reader.seekg(2, reader.cur);
-	reader.read((char*)&thisMaterial.clutValue, sizeof(thisMaterial.clutValue));
-	reader.seekg(2, reader.cur);
-	reader.read((char*)&thisMaterial.texturePage, sizeof(thisMaterial.texturePage));
-	reader.seekg(2, reader.cur);
+	reader.skip(2);
+	thisMaterial.clutValue = reader.read<unsigned short int>();
+	reader.skip(2);
+	thisMaterial.texturePage = reader.read<unsigned short int>();
 
 	return thisMaterial;
 }
 
 bool UVPointCorrectionAndExport(unsigned int materialID, bool isObject, std::string objectName, std::string outputFolder, Material thisMaterial,
-    std::vector<PolygonStruct>& polygons, bool exportLevelAnimations, std::vector<LevelAnimationSubframe>& levelSubframes)
+    Mesh& modelMesh, bool exportLevelAnimations, std::vector<LevelAnimationSubframe>& levelSubframes)
 {
-	std::vector<UV> materialUVs;
-	std::vector<unsigned int> polygonIDs;
-
-	for (unsigned int p = 0; p < polygons.size(); p++)
-	{
-		if (polygons[p].materialID == materialID)
-		{
-			polygonIDs.push_back(p);
-			materialUVs.push_back(polygons[p].uv1);
-			materialUVs.push_back(polygons[p].uv2);
-			materialUVs.push_back(polygons[p].uv3);
-		}
-	}
-
-	std::sort(materialUVs.begin(), materialUVs.end(), sortUCoord);
-	float leftCoord = materialUVs[0].u;
-	float rightCoord = materialUVs[materialUVs.size() - 1].u;
-	std::sort(materialUVs.begin(), materialUVs.end(), sortVCoord);
-	float southCoord = materialUVs[0].v;
-	float northCoord = materialUVs[materialUVs.size() - 1].v;
+	// The material's polygons are contiguous, so are the UVs of their corners
+	UV* materialUVs = &modelMesh.UVs[thisMaterial.polygonStart * 3];
+	size_t materialUVCount = thisMaterial.polygonCount * 3;
 
-	// Translate to bottom left
-	for (const unsigned int& polygonID : polygonIDs)
-	{
-		polygons[polygonID].uv1.u -= leftCoord;
-		polygons[polygonID].uv2.u -= leftCoord;
-		polygons[polygonID].uv3.u -= leftCoord;
-		polygons[polygonID].uv1.v -= southCoord;
-		polygons[polygonID].uv2.v -= southCoord;
-		polygons[polygonID].uv3.v -= southCoord;
-	}
+	UVBounds bounds = findUVBounds(materialUVs, materialUVCount);
+	float leftCoord = bounds.left;
+	float rightCoord = bounds.right;
+	float southCoord = bounds.south;
+	float northCoord = bounds.north;
 
-	// Stretch up to top right
-	float stretchInU = 1.0f / (rightCoord - leftCoord);
-	float stretchInV = 1.0f / (northCoord - southCoord);
-	if (rightCoord - leftCoord == 0)
-		stretchInU = 0.0f;
-	if (northCoord - southCoord == 0)
-		stretchInV = 0.0f;
-
-	for (const unsigned int& polygonID : polygonIDs)
-	{
-		polygons[polygonID].uv1.u *= stretchInU;
-		polygons[polygonID].uv2.u *= stretchInU;
-		polygons[polygonID].uv3.u *= stretchInU;
-		polygons[polygonID].uv1.v *= stretchInV;
-		polygons[polygonID].uv2.v *= stretchInV;
-		polygons[polygonID].uv3.v *= stretchInV;
-	}
+	// Translate to bottom left, and stretch up to top right
+	normaliseUVs(materialUVs, materialUVCount, bounds);
 
 	// Export textures
 	unsigned int leftCoordInt = floor(leftCoord * 255.0f + 0.5f);
@@ -503,8 +489,8 @@ bool UVPointCorrectionAndExport(unsigned int materialID, bool isObject, std::str
 
 					if (goToTexPageAndApplyCLUT(thisMaterial.texturePage, thisMaterial.clutValue, leftCoordInt, rightCoordInt, southCoordInt,
                         northCoordInt, objectName, outputFolder, (thisMaterial.textureID + 1), materialID, j + 1, empty) != 0)
-                    { std::cerr << std::format("	Export Error: Level subframe texture {}-tex{}-{}.png failed to export",
-                        objectName, (thisMaterial.textureID + 1), (j + 1)) << std::endl; }
+                    { std::cerr << std::format("	Export Error: Level subframe texture {}-tex{}-{}.{} failed to export",
+                        objectName, (thisMaterial.textureID + 1), (j + 1), textureImageExtension()) << std::endl; }
 				}
 			}
 			levelSubframes[i].subframeExportsThis = false;
@@ -513,7 +499,7 @@ bool UVPointCorrectionAndExport(unsigned int materialID, bool isObject, std::str
 	}
 	if (texPageReturnValue != 0)
 	{
-		std::cerr << std::format("	Export Error: Texture {}-tex{}.png failed to export", objectName, (thisMaterial.textureID + 1)) << std::endl;
+		std::cerr << std::format("	Export Error: Texture {}-tex{}.{} failed to export", objectName, (thisMaterial.textureID + 1), textureImageExtension()) << std::endl;
 		return false;
 	}
 	return true;
@@ -522,12 +508,13 @@ bool UVPointCorrectionAndExport(unsigned int materialID, bool isObject, std::str
 bool objectSubframePointCorrectionAndExport(unsigned int materialID, unsigned int textureID, std::string objectName,
     std::string outputFolder, ObjectAnimationSubframe subframe)
 {
-	std::sort(subframe.UVs.begin(), subframe.UVs.end(), sortUCoord);
-	float leftCoord = subframe.UVs[0].u;
-	float rightCoord = subframe.UVs[subframe.UVs.size() - 1].u;
-	std::sort(subframe.UVs.begin(), subframe.UVs.end(), sortVCoord);
-	float southCoord = subframe.UVs[0].v;
-	float northCoord = subframe.UVs[subframe.UVs.size() - 1].v;
+	if (subframe.UVs.empty()) { return false; }
+
+	UVBounds bounds = findUVBounds(subframe.UVs.data(), subframe.UVs.size());
+	float leftCoord = bounds.left;
+	float rightCoord = bounds.right;
+	float southCoord = bounds.south;
+	float northCoord = bounds.north;
 
 	unsigned int leftCoordInt = floor(leftCoord * 255.0f + 0.5f);
 	unsigned int rightCoordInt = floor(rightCoord * 255.0f + 0.5f);
@@ -539,8 +526,8 @@ bool objectSubframePointCorrectionAndExport(unsigned int materialID, unsigned in
         southCoordInt, northCoordInt, objectName, outputFolder, (textureID + 1), materialID, (subframe.subframeID + 1), empty);
 	if (texPageReturnValue != 0)
 	{
-		std::cerr << std::format("	Export Error: Object subframe texture {}-tex{}-{}.png failed to export",
-            objectName, (textureID + 1), (subframe.subframeID + 1)) << std::endl;
+		std::cerr << std::format("	Export Error: Object subframe texture {}-tex{}-{}.{} failed to export",
+            objectName, (textureID + 1), (subframe.subframeID + 1), textureImageExtension()) << std::endl;
 		return false;
 	}
 	return true;
@@ -0,0 +1,137 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "SpriteSheet.h"
+#include "TextureExporter.h"
+#include "SharedFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// A frame, kept as PS1 15-bit colours, since frames of level animations can each come with a different CLUT
+struct SpriteSheetFrame
+{
+	unsigned int width;
+	unsigned int height;
+	std::vector<unsigned short int> colours;
+};
+
+bool sheetsEnabled = false;
+
+// Frames of each texture, keyed by texture index then frame number
+std::unordered_map<unsigned int, std::map<unsigned int, SpriteSheetFrame>> spriteSheetFrames;
+
+void setSpriteSheetsEnabled(bool enabled)
+{
+	sheetsEnabled = enabled;
+}
+
+bool spriteSheetsEnabled()
+{
+	return sheetsEnabled;
+}
+
+void addSpriteSheetFrame(unsigned int textureIndex, unsigned int frame, const TextureImage& image)
+{
+	SpriteSheetFrame& sheetFrame = spriteSheetFrames[textureIndex][frame];
+	sheetFrame.width = image.width;
+	sheetFrame.height = image.height;
+	sheetFrame.colours.resize(image.width * image.height);
+	textureImageToColours(image, sheetFrame.colours.data());
+}
+
+bool exportSpriteSheet(std::string objectName, std::string outputFolder, unsigned int textureIndex)
+{
+	auto texture = spriteSheetFrames.find(textureIndex);
+	if (texture == spriteSheetFrames.end())
+		return true;
+
+	std::map<unsigned int, SpriteSheetFrame> frames = std::move(texture->second);
+	spriteSheetFrames.erase(texture);
+
+	// Each distinct frame gets a cell, the cells are as big as the biggest frame
+	std::vector<const SpriteSheetFrame*> cells;
+	std::map<unsigned int, unsigned int> cellsByFrame;
+	unsigned int cellWidth = 0;
+	unsigned int cellHeight = 0;
+
+	for (const auto& [frameNumber, frame] : frames)
+	{
+		unsigned int cell = 0;
+		while (cell < cells.size() && (cells[cell]->width != frame.width || cells[cell]->height != frame.height || cells[cell]->colours != frame.colours))
+			cell++;
+
+		if (cell == cells.size())
+		{
+			cells.push_back(&frame);
+			cellWidth = std::max(cellWidth, frame.width);
+			cellHeight = std::max(cellHeight, frame.height);
+		}
+		cellsByFrame[frameNumber] = cell;
+	}
+
+	// As close to square as the cells allow
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((double)cells.size()));
+	unsigned int rows = (cells.size() + columns - 1) / columns;
+	unsigned int sheetWidth = columns * cellWidth;
+	unsigned int sheetHeight = rows * cellHeight;
+
+	// Colour 0 is transparent, so any space around smaller frames is left clear
+	std::vector<unsigned short int> sheet(sheetWidth * sheetHeight, 0);
+
+	for (unsigned int cell = 0; cell < cells.size(); cell++)
+	{
+		unsigned int cellX = (cell % columns) * cellWidth;
+		unsigned int cellY = (cell / columns) * cellHeight;
+
+		for (unsigned int y = 0; y < cells[cell]->height; y++)
+		{
+			std::memcpy(&sheet[(cellY + y) * sheetWidth + cellX], &cells[cell]->colours[y * cells[cell]->width],
+				cells[cell]->width * sizeof(unsigned short int));
+		}
+	}
+
+	std::string sheetName = std::format("{}-tex{}-frames", objectName, textureIndex);
+	std::string sheetPath = std::format("{}{}{}", outputFolder, directorySeparator(), sheetName);
+
+	// One line per frame: the frame number, then the rectangle it takes up in the sheet in pixels from the top left
+	std::ofstream frameList(sheetPath + ".txt");
+	frameList << std::format("# {}.{}: frame x y width height", sheetName, textureImageExtension()) << std::endl;
+	for (const auto& [frameNumber, frame] : frames)
+	{
+		unsigned int cell = cellsByFrame[frameNumber];
+		frameList << std::format("{} {} {} {} {}", frameNumber, (cell % columns) * cellWidth, (cell / columns) * cellHeight, frame.width, frame.height) << std::endl;
+	}
+	frameList.close();
+
+	TextureImage sheetImage;
+	sheetImage.width = sheetWidth;
+	sheetImage.height = sheetHeight;
+	sheetImage.bitDepth = 0;
+	sheetImage.texels = sheet.data();
+	sheetImage.texelStride = sheetWidth;
+	sheetImage.palette = nullptr;
+	sheetImage.paletteSize = 0;
+
+	bool sheetWritten = exportTextureImage(sheetImage, std::format("{}.{}", sheetPath, textureImageExtension())) == 0;
+	return sheetWritten && !frameList.fail();
+}
@@ -0,0 +1,200 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "TextureAtlas.h"
+#include "TextureExporter.h"
+#include "SharedFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+
+// A material's texture, kept as PS1 15-bit colours so the atlas can be written as a direct colour image
+struct AtlasRegion
+{
+	unsigned int materialID;
+	unsigned int width;
+	unsigned int height;
+	std::vector<unsigned short int> colours;
+
+	// Top left of the texture in the atlas, inside its 1 texel border
+	unsigned int x;
+	unsigned int y;
+};
+
+bool atlasEnabled = false;
+std::vector<AtlasRegion> atlasRegions;
+
+// Largest atlas that will be made, in either direction
+constexpr unsigned int maxAtlasSize = 8192;
+
+void setTextureAtlasEnabled(bool enabled)
+{
+	atlasEnabled = enabled;
+}
+
+bool textureAtlasEnabled()
+{
+	return atlasEnabled;
+}
+
+std::string textureAtlasFileName(std::string objectName)
+{
+	return std::format("{}-atlas.{}", objectName, textureImageExtension());
+}
+
+void clearTextureAtlas()
+{
+	atlasRegions.clear();
+}
+
+void addTextureToAtlas(unsigned int materialID, const TextureImage& image)
+{
+	AtlasRegion region;
+	region.materialID = materialID;
+	region.width = image.width;
+	region.height = image.height;
+	region.colours.resize(image.width * image.height);
+	region.x = 0;
+	region.y = 0;
+
+	textureImageToColours(image, region.colours.data());
+
+	atlasRegions.push_back(std::move(region));
+}
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+	unsigned int powerOfTwo = 1;
+	while (powerOfTwo < value)
+		powerOfTwo <<= 1;
+	return powerOfTwo;
+}
+
+// Shelf packing: the textures go left to right in rows, tallest first, starting a new row when one is full
+// Each texture gets a 1 texel border, so that filtering at its edges doesn't pick up its neighbours
+// Returns the height used
+static unsigned int packAtlasRegions(std::vector<AtlasRegion*>& regions, unsigned int atlasWidth)
+{
+	unsigned int shelfX = 0;
+	unsigned int shelfY = 0;
+	unsigned int shelfHeight = 0;
+
+	for (AtlasRegion* region : regions)
+	{
+		if (shelfX + region->width + 2 > atlasWidth)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		region->x = shelfX + 1;
+		region->y = shelfY + 1;
+		shelfX += region->width + 2;
+		shelfHeight = std::max(shelfHeight, region->height + 2);
+	}
+
+	return shelfY + shelfHeight;
+}
+
+bool exportTextureAtlas(std::string objectName, std::string outputFolder, Mesh& modelMesh, std::vector<Material>& materials)
+{
+	if (atlasRegions.empty())
+		return true;
+
+	std::vector<AtlasRegion*> regions;
+	unsigned int widestRegion = 0;
+	unsigned long long int totalArea = 0;
+	for (AtlasRegion& region : atlasRegions)
+	{
+		regions.push_back(&region);
+		widestRegion = std::max(widestRegion, region.width + 2);
+		totalArea += (unsigned long long int)(region.width + 2) * (region.height + 2);
+	}
+
+	std::stable_sort(regions.begin(), regions.end(), [](const AtlasRegion* a, const AtlasRegion* b) { return a->height > b->height; });
+
+	// Start from the smallest square that could fit everything, and widen it until the packed height fits in a square
+	unsigned int atlasWidth = nextPowerOfTwo(std::max(widestRegion, (unsigned int)std::ceil(std::sqrt((double)totalArea))));
+	unsigned int atlasHeight = nextPowerOfTwo(packAtlasRegions(regions, atlasWidth));
+	while (atlasHeight > atlasWidth && atlasWidth < maxAtlasSize)
+	{
+		atlasWidth <<= 1;
+		atlasHeight = nextPowerOfTwo(packAtlasRegions(regions, atlasWidth));
+	}
+
+	if (atlasWidth > maxAtlasSize || atlasHeight > maxAtlasSize)
+	{
+		clearTextureAtlas();
+		return false;
+	}
+
+	// Colour 0 is transparent, so the space between textures is left clear
+	std::vector<unsigned short int> atlas(atlasWidth * atlasHeight, 0);
+
+	for (const AtlasRegion& region : atlasRegions)
+	{
+		for (unsigned int y = 0; y < region.height; y++)
+		{
+			unsigned short int* atlasRow = &atlas[(region.y + y) * atlasWidth + region.x];
+			const unsigned short int* regionRow = &region.colours[y * region.width];
+
+			std::memcpy(atlasRow, regionRow, region.width * sizeof(unsigned short int));
+
+			// Border columns repeat the texture's edge texels
+			atlasRow[-1] = regionRow[0];
+			atlasRow[region.width] = regionRow[region.width - 1];
+		}
+
+		// Border rows repeat the texture's top and bottom rows, including the corners
+		std::memcpy(&atlas[(region.y - 1) * atlasWidth + region.x - 1], &atlas[region.y * atlasWidth + region.x - 1],
+			(region.width + 2) * sizeof(unsigned short int));
+		std::memcpy(&atlas[(region.y + region.height) * atlasWidth + region.x - 1], &atlas[(region.y + region.height - 1) * atlasWidth + region.x - 1],
+			(region.width + 2) * sizeof(unsigned short int));
+
+		// Move the material's UVs into its place in the atlas
+		// V goes up from the bottom of the image, where the atlas' rows go down from the top
+		const Material& material = materials[region.materialID];
+		float uOffset = (float)region.x / atlasWidth;
+		float uScale = (float)region.width / atlasWidth;
+		float vOffset = (float)(atlasHeight - region.y - region.height) / atlasHeight;
+		float vScale = (float)region.height / atlasHeight;
+
+		for (unsigned int c = material.polygonStart * 3; c < (material.polygonStart + material.polygonCount) * 3; c++)
+		{
+			modelMesh.UVs[c].u = uOffset + (modelMesh.UVs[c].u * uScale);
+			modelMesh.UVs[c].v = vOffset + (modelMesh.UVs[c].v * vScale);
+		}
+	}
+
+	clearTextureAtlas();
+
+	TextureImage atlasImage;
+	atlasImage.width = atlasWidth;
+	atlasImage.height = atlasHeight;
+	atlasImage.bitDepth = 0;
+	atlasImage.texels = atlas.data();
+	atlasImage.texelStride = atlasWidth;
+	atlasImage.palette = nullptr;
+	atlasImage.paletteSize = 0;
+
+	if (textureEmbeddingEnabled())
+		return embedTextureImage(atlasImage, textureAtlasFileName(objectName)) == 0;
+
+	return exportTextureImage(atlasImage, std::format("{}{}{}", outputFolder, directorySeparator(), textureAtlasFileName(objectName))) == 0;
+}
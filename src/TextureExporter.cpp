@@ -14,261 +14,601 @@
     You should have received a copy of the GNU General Public License
     along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
 
-#include "png.h"
-
 #include "SharedFunctions.h"
 #include "TextureExporter.h"
+#include "MappedFile.h"
+#include "ScratchArena.h"
+#include "TextureKernels.h"
+#include "ImageSink.h"
+#include "ThreadPool.h"
+#include "TextureAtlas.h"
+#include "SpriteSheet.h"
 
 #include <filesystem>
 #include <format>
+#include <cstring>
+#include <bit>
+#include <unordered_map>
+#include <iostream>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+// VRAM is kept as one flat 512x512 block, row-major, so a pixel is at [y * 512 + x]
+// Aligned to a cache line so that rows start on cache line boundaries
+alignas(64) unsigned short int textureData[512 * 512];
+
+// Animated textures are exported by copying rectangles around VRAM, which is done on a copy-on-write overlay of the VRM
+// The overlay is split into 16x16 tiles, and a tile is only copied from the VRM the first time a pixel in it is written
+// Reads of tiles that haven't been written fall through to the VRM, and resetting just forgets the tiles that were written
+alignas(64) unsigned short int textureDataVRAMMovement[512 * 512];
+bool VRAMTileModified[32 * 32];
+std::vector<unsigned short int> modifiedVRAMTiles;
+
+static inline unsigned int VRAMTileOf(unsigned int pixelIndex)
+{
+	return ((pixelIndex >> 13) << 5) | ((pixelIndex & 0x1FF) >> 4);
+}
 
-unsigned short int** textureData = new unsigned short int* [512];
-unsigned short int** textureDataVRAMMovement = new unsigned short int* [512];
-
-int initialiseVRM(std::string path)
+static inline unsigned short int readModifiedVRAM(unsigned int pixelIndex)
 {
-	std::ifstream reader(path, std::ifstream::binary);
-	reader.exceptions(std::ifstream::eofbit);
-	reader.seekg(20, reader.beg);
+	return VRAMTileModified[VRAMTileOf(pixelIndex)] ? textureDataVRAMMovement[pixelIndex] : textureData[pixelIndex];
+}
 
-	for (int y = 0; y < 512; y++)
+static inline void writeModifiedVRAM(unsigned int pixelIndex, unsigned short int value)
+{
+	unsigned int tile = VRAMTileOf(pixelIndex);
+	if (!VRAMTileModified[tile])
 	{
-		textureData[y] = new unsigned short int[512];
+		unsigned int tileStart = ((tile >> 5) << 13) | ((tile & 0x1F) << 4);
+		for (unsigned int row = 0; row < 16; row++)
+			std::memcpy(&textureDataVRAMMovement[tileStart + (row * 512)], &textureData[tileStart + (row * 512)], 16 * sizeof(unsigned short int));
+
+		VRAMTileModified[tile] = true;
+		modifiedVRAMTiles.push_back(tile);
 	}
 
-	for (int y = 0; y < 512; y++)
+	textureDataVRAMMovement[pixelIndex] = value;
+}
+
+// Scratch memory for decoding textures, reset after each model
+ScratchArena textureArena;
+
+void resetTextureArena()
+{
+	textureArena.reset();
+}
+
+// Encoder the textures are written with, and the buffer they are encoded into
+std::unique_ptr<ImageSink> textureImageSink = std::make_unique<PNGImageSink>();
+std::vector<unsigned char> encodedTexture;
+
+void setTextureImageSink(std::unique_ptr<ImageSink> imageSink)
+{
+	textureImageSink = std::move(imageSink);
+}
+
+std::string textureImageExtension()
+{
+	return textureImageSink->extension();
+}
+
+// Encoding textures can be handed to a pool of worker threads
+// Decoding stays on the calling thread, as it depends on the state of VRAM at the time, so each job gets its own copy of the texture
+std::unique_ptr<ThreadPool> textureEncodePool;
+std::mutex failedTextureWritesMutex;
+std::vector<std::string> failedTextureWrites;
+
+struct TextureEncodeJob
+{
+	TextureImage image;
+	std::vector<unsigned short int> texels;
+	std::vector<unsigned int> palette;
+	std::string path;
+	FILE* file;
+};
+
+void setTextureExportJobs(unsigned int jobCount)
+{
+	textureEncodePool.reset();
+
+	// With 1 job, textures are encoded on the calling thread
+	if (jobCount > 1)
+		textureEncodePool = std::make_unique<ThreadPool>(jobCount, jobCount * 4);
+}
+
+bool finishTextureExports()
+{
+	if (textureEncodePool)
+		textureEncodePool->wait();
+
+	std::lock_guard<std::mutex> lock(failedTextureWritesMutex);
+	for (const std::string& path : failedTextureWrites)
+		std::cerr << std::format("	Export Error: Texture {} failed to write", path) << std::endl;
+
+	bool allWritten = failedTextureWrites.empty();
+	failedTextureWrites.clear();
+	return allWritten;
+}
+
+static bool encodeAndWriteTexture(const TextureImage& image, FILE* file, ScratchArena& arena, std::vector<unsigned char>& encoded)
+{
+	ScratchArena::Scope encodeScope(arena);
+
+	bool written = textureImageSink->encode(image, arena, encoded)
+		&& fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+
+	return fclose(file) == 0 && written;
+}
+
+// The file is opened straight away, so that a texture that can't be created is reported as failing to export
+// Only encoding and writing it are left to the pool
+int exportTextureImage(const TextureImage& image, std::string path)
+{
+	FILE* writeFile = fopen(path.c_str(), "wb");
+	if (!writeFile)
+		return 1;
+
+	if (!textureEncodePool)
+		return encodeAndWriteTexture(image, writeFile, textureArena, encodedTexture) ? 0 : 1;
+
+	auto job = std::make_shared<TextureEncodeJob>();
+	job->image = image;
+	job->texels.resize(image.width * image.height);
+	for (unsigned int y = 0; y < image.height; y++)
+		std::memcpy(&job->texels[y * image.width], &image.texels[y * image.texelStride], image.width * sizeof(unsigned short int));
+	job->palette.assign(image.palette, image.palette + image.paletteSize);
+	job->image.texels = job->texels.data();
+	job->image.texelStride = image.width;
+	job->image.palette = job->palette.data();
+	job->path = std::move(path);
+	job->file = writeFile;
+
+	textureEncodePool->submit([job]()
 	{
-		for (int x = 0; x < 512; x++)
+		thread_local ScratchArena workerArena;
+		thread_local std::vector<unsigned char> workerEncoded;
+
+		if (!encodeAndWriteTexture(job->image, job->file, workerArena, workerEncoded))
 		{
-			reader.read((char*)&(textureData[y][x]), 2);
+			std::lock_guard<std::mutex> lock(failedTextureWritesMutex);
+			failedTextureWrites.push_back(job->path);
 		}
+	});
+
+	return 0;
+}
+
+bool embedTextures = false;
+std::unordered_map<std::string, std::vector<unsigned char>> embeddedTextures;
+
+void setTextureEmbedding(bool enabled)
+{
+	embedTextures = enabled;
+}
+
+bool textureEmbeddingEnabled()
+{
+	return embedTextures;
+}
+
+// Embedded textures are encoded straight away on the calling thread, as the model that holds them is written as soon as its textures are done
+int embedTextureImage(const TextureImage& image, std::string fileName)
+{
+	ScratchArena::Scope encodeScope(textureArena);
+
+	std::vector<unsigned char>& encoded = embeddedTextures[fileName];
+	if (!textureImageSink->encode(image, textureArena, encoded))
+	{
+		embeddedTextures.erase(fileName);
+		return 1;
 	}
+	return 0;
+}
+
+const std::vector<unsigned char>* findEmbeddedTexture(std::string fileName)
+{
+	auto embeddedTexture = embeddedTextures.find(fileName);
+	if (embeddedTexture == embeddedTextures.end())
+		return nullptr;
+	return &embeddedTexture->second;
+}
+
+void clearEmbeddedTextures()
+{
+	embeddedTextures.clear();
+}
+
+// The VRAM generation identifies what is in the modified VRAM
+// Generation 0 is the VRM as it was loaded, every rectangle copied into the overlay moves it to a new generation
+// and resetting the overlay moves it back to 0
+unsigned int VRAMGeneration = 0;
+unsigned int nextVRAMGeneration = 1;
+
+// Decoded texture pages, so that materials and subframes that share a texture page and CLUT don't decode it again
+// Each page holds the palette indices of its 256x256 texels, decoded a 16x16 tile at a time as they are needed,
+// and its palette as RGBA8 pixels (16 bit pages have no palette, their "indices" are the 15-bit colours themselves)
+struct DecodedTexturePage
+{
+	unsigned int generation;
+	std::vector<unsigned short int> indices;
+	bool tileDecoded[16 * 16];
+	std::vector<unsigned int> palette;
+};
+
+// Keyed by (VRAM generation << 32) | (texture page << 16) | CLUT
+std::unordered_map<unsigned long long int, DecodedTexturePage> decodedTexturePages;
+TexturePageCacheStatistics texturePageCacheStatistics;
 
-	for (int y = 0; y < 512; y++)
+// Upper limit on the number of pages kept, the cache is emptied when it is reached
+constexpr size_t maxDecodedTexturePages = 128;
+
+// Drops the pages of earlier modified VRAM generations, which can never be looked up again
+static void evictStaleTexturePages()
+{
+	for (auto page = decodedTexturePages.begin(); page != decodedTexturePages.end();)
 	{
-		textureDataVRAMMovement[y] = new unsigned short int[512];
+		if (page->second.generation != 0 && page->second.generation != VRAMGeneration)
+			page = decodedTexturePages.erase(page);
+		else
+			page++;
 	}
+}
 
-	resetModifiedVRAM();
+static void setVRAMGeneration(unsigned int generation)
+{
+	if (generation == VRAMGeneration)
+		return;
 
-	return 0;
+	VRAMGeneration = generation;
+	evictStaleTexturePages();
 }
 
-bool resetModifiedVRAM()
+TexturePageCacheStatistics getTexturePageCacheStatistics()
 {
-	for (unsigned int y = 0; y < 512; y++)
+	return texturePageCacheStatistics;
+}
+
+int initialiseVRM(std::string path)
+{
+	MappedFile vrmMapping;
+
+	if (!vrmMapping.open(path))
 	{
-		for (unsigned int x = 0; x < 512; x++)
-		{
-			textureDataVRAMMovement[y][x] = textureData[y][x];
-		}
+		initialiseVRM(nullptr, 0);
+		return 1;
+	}
+
+	return initialiseVRM(vrmMapping.data(), vrmMapping.size());
+}
+
+int initialiseVRM(const unsigned char* vrmData, size_t vrmSize)
+{
+	int returnValue = 0;
+
+	// The VRM body starts after its 20 byte header and is loaded with a single copy
+	// Anything missing from the end of the file (or the entire file, if there is no VRM) is left black
+	size_t bytesCopied = 0;
+	if (vrmData != nullptr && vrmSize > 20)
+	{
+		bytesCopied = vrmSize - 20;
+		if (bytesCopied > sizeof(textureData))
+			bytesCopied = sizeof(textureData);
+		std::memcpy(textureData, vrmData + 20, bytesCopied);
+	}
+	else
+		returnValue = 1;
+
+	std::memset((unsigned char*)textureData + bytesCopied, 0, sizeof(textureData) - bytesCopied);
+
+	// Nothing decoded from the previous VRM is valid any more
+	decodedTexturePages.clear();
+
+	if constexpr (std::endian::native == std::endian::big)
+	{
+		for (unsigned int i = 0; i < 512 * 512; i++)
+			textureData[i] = (textureData[i] >> 8) | (textureData[i] << 8);
 	}
 
+	resetModifiedVRAM();
+
+	return returnValue;
+}
+
+bool resetModifiedVRAM()
+{
+	for (const unsigned short int& tile : modifiedVRAMTiles)
+		VRAMTileModified[tile] = false;
+
+	modifiedVRAMTiles.clear();
+
+	setVRAMGeneration(0);
+
 	return true;
 }
 
 int copyRectangleInVRM(unsigned short int xCoordinateDestination, unsigned short int yCoordinateDestination, unsigned short int xSize, unsigned short int ySize,
 	unsigned short int xCoordinateSource, unsigned short int yCoordinateSource, bool useAlreadyModifiedVRAMAsBase)
 {
+	if (!useAlreadyModifiedVRAMAsBase)
+		resetModifiedVRAM();
+
+	if (xSize != 0 && ySize != 0)
+		setVRAMGeneration(nextVRAMGeneration++);
+
+	// Pixels are copied one at a time in order, so overlapping rectangles behave the same as they would in place
+	// The rectangles are clipped to VRAM's edges rather than running on into the next row, with pixels outside of VRAM read as 0
 	for (unsigned int y = 0; y < ySize; y++)
 	{
+		unsigned int destinationY = yCoordinateDestination + y;
+		unsigned int sourceY = yCoordinateSource + y;
+
+		if (destinationY >= 512)
+			break;
+
 		for (unsigned int x = 0; x < xSize; x++)
 		{
-			if (!useAlreadyModifiedVRAMAsBase)
-				resetModifiedVRAM();
+			unsigned int destinationX = xCoordinateDestination + x;
+			unsigned int sourceX = xCoordinateSource + x;
 
-			textureDataVRAMMovement[yCoordinateDestination + y][xCoordinateDestination + x] = textureDataVRAMMovement[yCoordinateSource + y][xCoordinateSource + x];
+			if (destinationX >= 512)
+				break;
+
+			unsigned short int value = sourceX < 512 && sourceY < 512 ? readModifiedVRAM(sourceY * 512 + sourceX) : 0;
+			writeModifiedVRAM(destinationY * 512 + destinationX, value);
 		}
 	}
 
 	return 0;
 }
 
-int goToTexPageAndApplyCLUT(unsigned short int texturePage, unsigned short int clutValue, unsigned int left, unsigned int right,
-	unsigned int south, unsigned int north, std::string objectName, std::string outputFolder, unsigned int textureIndex,
-	unsigned int materialIndex, unsigned int subframe, std::vector<LevelAnimationSubframe>& levelSubframes)
+// 4 bit pages have 4 texels to a VRAM pixel, 8 bit pages have 2, and 16 bit pages have 1 (0 for the reserved colour depth)
+static unsigned int texelsPerVRAMPixel(unsigned short int texturePage)
 {
-	// Initialise texture page
+	switch ((texturePage >> 7) & 0x3)
+	{
+	case 0:
+		return 4;
+	case 1:
+		return 2;
+	case 2:
+		return 1;
+	default:
+		return 0;
+	}
+}
 
-	int texturePageX = (texturePage << 6) & 0x07C0;
-	int texturePageY = (texturePage << 4) & 0x0100 + ((texturePage >> 2) & 0x0200);
-	texturePageX %= 512;
-	texturePageX += 512;
-	texturePageX %= 512;
-	unsigned short int** pixels = new unsigned short int*[256];
+static void decodePalette(unsigned short int texturePage, unsigned short int clutValue, std::vector<unsigned int>& colours)
+{
 	unsigned int colourLimit = 16;
+	if (((texturePage >> 7) & 0x3) == 1) // 8 bit
+		colourLimit = 256;
+
+	int colourTableX = (clutValue & 0x3F) << 4;
+	int colourTableY = clutValue >> 6;
+	colourTableX %= 512;
+	colourTableX += 512;
+	colourTableX %= 512;
 
-	for (int y = 0; y < 256; y++)
+	ScratchArena::Scope paletteScope(textureArena);
+	unsigned short int* CLUT = textureArena.allocate<unsigned short int>(colourLimit);
+
+	for (int x = 0; x < colourLimit; x++)
 	{
-		pixels[y] = new unsigned short int[256];
+		unsigned short int val = 0;
+		int wrappedWidth = (colourTableX + x) % 512;
+		if (colourTableY < 512)
+		{
+			val = readModifiedVRAM(colourTableY * 512 + wrappedWidth);
+		}
+
+		CLUT[x] = val;
 	}
 
-	bool* subframeCheckAlreadyDone = new bool[levelSubframes.size()];
+	colours.resize(colourLimit);
+	textureKernels().convertColours(CLUT, colours.data(), colourLimit);
+}
+
+// Finds the decoded page for this texture page and CLUT in the current VRAM generation, or starts a new one with just its palette decoded
+// 16 bit pages hold their colours directly, so they have no palette and the CLUT is ignored
+static DecodedTexturePage& findDecodedTexturePage(unsigned short int texturePage, unsigned short int clutValue)
+{
+	bool directColour = ((texturePage >> 7) & 0x3) == 2;
+	if (directColour)
+		clutValue = 0;
 
-	for (unsigned int i = 0; i < levelSubframes.size(); i++)
+	unsigned long long int key = ((unsigned long long int)VRAMGeneration << 32) | ((unsigned int)texturePage << 16) | clutValue;
+
+	auto cachedPage = decodedTexturePages.find(key);
+	if (cachedPage != decodedTexturePages.end())
 	{
-		subframeCheckAlreadyDone[i] = false;
+		texturePageCacheStatistics.hits++;
+		return cachedPage->second;
 	}
 
-	for (int y = 0; y < 256; y++)
+	texturePageCacheStatistics.misses++;
+
+	if (decodedTexturePages.size() >= maxDecodedTexturePages)
+		decodedTexturePages.clear();
+
+	DecodedTexturePage& page = decodedTexturePages[key];
+	page.generation = VRAMGeneration;
+	page.indices.resize(256 * 256);
+	std::memset(page.tileDecoded, 0, sizeof(page.tileDecoded));
+	if (!directColour)
+		decodePalette(texturePage, clutValue, page.palette);
+
+	return page;
+}
+
+// Decodes the palette indices of the 16x16 tiles covering the rectangle that haven't been decoded yet
+// texturePageX and texturePageY are where the page starts in VRAM
+static void decodeTexturePageTiles(DecodedTexturePage& page, unsigned short int texturePage, int texturePageX, int texturePageY,
+	unsigned int left, unsigned int right, unsigned int south, unsigned int north)
+{
+	unsigned int colourDepth = (texturePage >> 7) & 0x3;
+	unsigned int texelsPerPixel = texelsPerVRAMPixel(texturePage);
+
+	// VRAM pixels of one row of the page, before they are split into texels (16 bit texels are read straight into the page)
+	unsigned short int VRAMRow[256];
+
+	const TextureKernels& kernels = textureKernels();
+
+	for (unsigned int tileY = north / 16; tileY <= south / 16; tileY++)
 	{
-		for (int x = 0; x < 256;)
+		// Decode the rows of the span from the first to the last tile that haven't been decoded yet in one go
+		unsigned int firstTileX = 16;
+		unsigned int lastTileX = 0;
+		for (unsigned int tileX = left / 16; tileX <= right / 16; tileX++)
 		{
-			int wrappedWidth;
-			if (((texturePage >> 7) & 0x3) == 0) // 4 bit
+			if (!page.tileDecoded[tileY * 16 + tileX])
 			{
-				colourLimit = 16;
-				unsigned short int val = 0;
-				wrappedWidth = (texturePageX + (x / 4)) % 512;
+				if (firstTileX == 16)
+					firstTileX = tileX;
+				lastTileX = tileX;
+				page.tileDecoded[tileY * 16 + tileX] = true;
+			}
+		}
 
-				if ((texturePageY + y) < 512)
-					val = textureDataVRAMMovement[texturePageY + y][wrappedWidth];
+		if (firstTileX == 16)
+			continue;
 
-				pixels[y][x++] = val & 0x000F;
-				pixels[y][x++] = (val & 0x00F0) >> 4;
-				pixels[y][x++] = (val & 0x0F00) >> 8;
-				pixels[y][x] = (val & 0xF000) >> 12;
-			}
-			else if (((texturePage >> 7) & 0x3) == 1) // 8 bit
-			{
-				colourLimit = 256;
-				unsigned short int val = 0;
-				wrappedWidth = (texturePageX + (x / 2)) % 512;
+		unsigned int spanLeft = firstTileX * 16;
+		unsigned int spanWidth = (lastTileX + 1 - firstTileX) * 16;
 
-				if ((texturePageY + y) < 512)
-					val = textureDataVRAMMovement[texturePageY + y][wrappedWidth];
+		for (unsigned int y = tileY * 16; y < (tileY + 1) * 16; y++)
+		{
+			unsigned short int* texels = &page.indices[y * 256 + spanLeft];
 
-				pixels[y][x++] = val & 0x00FF;
-				pixels[y][x] = (val & 0xFF00) >> 8;
+			// Reserved colour depth, there is nothing sensible to decode
+			if (texelsPerPixel == 0)
+			{
+				std::memset(texels, 0, spanWidth * sizeof(unsigned short int));
+				continue;
 			}
-			else if (((texturePage >> 7) & 0x3) == 2) // 16 bit
+
+			unsigned short int* VRAMPixels = colourDepth == 2 ? texels : VRAMRow;
+			unsigned int VRAMPixelCount = spanWidth / texelsPerPixel;
+
+			for (unsigned int i = 0; i < VRAMPixelCount; i++)
 			{
-				colourLimit = 65536;
 				unsigned short int val = 0;
-				wrappedWidth = (texturePageX + x) % 512;
+				int wrappedWidth = (texturePageX + (spanLeft / texelsPerPixel) + i) % 512;
 
 				if ((texturePageY + y) < 512)
-					val = textureDataVRAMMovement[texturePageY + y][wrappedWidth];
+					val = readModifiedVRAM((texturePageY + y) * 512 + wrappedWidth);
 
-				pixels[y][x] = val;
+				VRAMPixels[i] = val;
 			}
 
-			if (x >= left && x < right && y >= north && y < south)
-			{
-				for (unsigned int i = 0; i < levelSubframes.size(); i++)
-				{
-					if (!subframeCheckAlreadyDone[i]
-						&& wrappedWidth >= levelSubframes[i].xCoordinateDestination
-						&& wrappedWidth < (levelSubframes[i].xCoordinateDestination + levelSubframes[i].xSize)
-						&& (texturePageY + y) >= levelSubframes[i].yCoordinateDestination
-						&& (texturePageY + y) < (levelSubframes[i].yCoordinateDestination + levelSubframes[i].ySize))
-					{
-						levelSubframes[i].subframeExportsThis = true;
-						subframeCheckAlreadyDone[i] = true;
-					}
-				}
-			}
-			x++;
+			if (colourDepth == 0) // 4 bit
+				kernels.expandNibbles(VRAMRow, texels, VRAMPixelCount);
+			else if (colourDepth == 1) // 8 bit
+				kernels.expandBytes(VRAMRow, texels, VRAMPixelCount);
 		}
 	}
+}
 
-	free(subframeCheckAlreadyDone);
+// Marks the level animations whose destination overlaps the VRAM pixels a texture rectangle was read from
+// A VRAM pixel counts as read if its last texel is in columns left to right - 1 and rows north to south - 1
+// Those pixels are one rectangle of VRAM, or two when it wraps past the right edge
+static void markLevelSubframesOverlapping(std::vector<LevelAnimationSubframe>& levelSubframes, unsigned short int texturePage,
+	int texturePageX, int texturePageY, unsigned int left, unsigned int right, unsigned int south, unsigned int north)
+{
+	unsigned int texelsPerPixel = texelsPerVRAMPixel(texturePage);
+	if (levelSubframes.empty() || texelsPerPixel == 0)
+		return;
 
-	//Initialise CLUT
+	unsigned int firstPixel = left / texelsPerPixel;
+	unsigned int endPixel = right / texelsPerPixel;
+	if (firstPixel >= endPixel || north >= south)
+		return;
 
-	int colourTableX = (clutValue & 0x3F) << 4;
-	int colourTableY = clutValue >> 6;
-	colourTableX %= 512;
-	colourTableX += 512;
-	colourTableX %= 512;
-	std::vector<unsigned int> colours;
+	int rectangleX = (texturePageX + firstPixel) % 512;
+	int rectangleWidth = endPixel - firstPixel;
+	int rectangleY = texturePageY + north;
+	int rectangleHeight = south - north;
 
-	for (int x = 0; x < colourLimit; x++)
-	{
-		unsigned short int val = 0;
-		int wrappedWidth = (colourTableX + x) % 512;
-		if (colourTableY < 512)
-		{
-			val = textureDataVRAMMovement[colourTableY][wrappedWidth];
-		}
+	// The part of the rectangle past the right edge of VRAM wraps back to column 0
+	int wrappedWidth = std::max(0, rectangleX + rectangleWidth - 512);
+	rectangleWidth -= wrappedWidth;
 
-		unsigned short int alpha = val >> 15;
-		unsigned short int blue = (((val << 1) >> 11) << 3);
-		unsigned short int green = (((val << 6) >> 11) << 3);
-		unsigned short int red = (((val << 11) >> 11) << 3);
+	for (LevelAnimationSubframe& subframe : levelSubframes)
+	{
+		if (subframe.xSize == 0 || subframe.ySize == 0)
+			continue;
 
-		alpha &= 0xFF;
-		blue &= 0xFF;
-		green &= 0xFF;
-		red &= 0xFF;
+		int subframeLeft = subframe.xCoordinateDestination;
+		int subframeRight = subframe.xCoordinateDestination + subframe.xSize;
 
-		if (alpha != 0 || blue != 0 || green != 0 || red != 0)
-		{
-			alpha = 255;
-		}
-		else
-		{
-			alpha = 0;
-		}
+		bool rowsOverlap = rectangleY < (subframe.yCoordinateDestination + subframe.ySize)
+			&& subframe.yCoordinateDestination < (rectangleY + rectangleHeight);
+		bool columnsOverlap = (rectangleX < subframeRight && subframeLeft < (rectangleX + rectangleWidth))
+			|| (wrappedWidth > 0 && subframeLeft < wrappedWidth);
 
-		colours.push_back(alpha * 0x1000000 + red * 0x10000 + green * 0x100 + blue);
+		if (rowsOverlap && columnsOverlap)
+			subframe.subframeExportsThis = true;
 	}
+}
 
-	//Write to file
+int goToTexPageAndApplyCLUT(unsigned short int texturePage, unsigned short int clutValue, unsigned int left, unsigned int right,
+	unsigned int south, unsigned int north, std::string objectName, std::string outputFolder, unsigned int textureIndex,
+	unsigned int materialIndex, unsigned int subframe, std::vector<LevelAnimationSubframe>& levelSubframes)
+{
+	// Initialise texture page
 
-	png_structp pngPointer = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-	png_infop infoPointer = png_create_info_struct(pngPointer);
-	png_byte** rowPointers = NULL;
+	// Everything this texture allocates from the arena is given back when it returns
+	ScratchArena::Scope textureScope(textureArena);
 
-	png_set_IHDR(pngPointer, infoPointer, (right - left + 1), (south - north + 1), 8,
-		PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	int texturePageX = (texturePage << 6) & 0x07C0;
+	int texturePageY = (texturePage << 4) & 0x0100 + ((texturePage >> 2) & 0x0200);
+	texturePageX %= 512;
+	texturePageX += 512;
+	texturePageX %= 512;
 
-	rowPointers = static_cast<png_byte**>(png_malloc(pngPointer, (south - north + 1) * sizeof(png_byte*)));
+	DecodedTexturePage& page = findDecodedTexturePage(texturePage, clutValue);
+	decodeTexturePageTiles(page, texturePage, texturePageX, texturePageY, left, right, south, north);
 
-	for (unsigned int y = north; y <= south; y++)
-	{
-		png_byte* row = static_cast<png_byte*>(png_malloc(pngPointer, (right - left + 1) * 4));
-		rowPointers[y - north] = row;
-		for (unsigned int x = left; x <= right; x++)
-		{
-			int pixel = pixels[y][x];
-			*row++ = (colours[pixel] & 0x00FF0000) >> 16;
-			*row++ = (colours[pixel] & 0x0000FF00) >> 8;
-			*row++ = (colours[pixel] & 0x000000FF);
-			*row++ = (colours[pixel] & 0xFF000000) >> 24;
-		}
-	}
+	markLevelSubframesOverlapping(levelSubframes, texturePage, texturePageX, texturePageY, left, right, south, north);
 
-	FILE* writeFile;
+	unsigned int texelsPerPixel = texelsPerVRAMPixel(texturePage);
 
-	std::string textureIndexString = std::format("{}", textureIndex);
-	if (subframe > 0)
+	// 4 and 8 bit pages are handed to the image sink as palette images, with the decoded CLUT as the palette
+	TextureImage image;
+	image.width = right - left + 1;
+	image.height = south - north + 1;
+	image.bitDepth = texelsPerPixel == 4 ? 4 : texelsPerPixel == 2 ? 8 : 0;
+	image.texels = &page.indices[north * 256 + left];
+	image.texelStride = 256;
+	image.palette = page.palette.data();
+	image.paletteSize = page.palette.size();
+
+	// In atlas mode, a material's texture is kept to be packed with the rest of the model's textures
+	if (subframe == 0 && textureAtlasEnabled())
 	{
-		textureIndexString += std::format("-{}", subframe);
+		addTextureToAtlas(materialIndex, image);
+		return 0;
 	}
 
-	writeFile = fopen(std::format("{}{}{}-tex{}.png", outputFolder, directorySeparator(), objectName, textureIndexString).c_str(), "wb");
-	if (!writeFile)
+	// In sprite sheet mode, animation frames are kept to be written together once the material's last frame is done
+	if (subframe != 0 && spriteSheetsEnabled())
 	{
-		for (int y = 0; y < 256; y++)
-		{
-			delete (pixels[y]);
-		}
-		png_destroy_write_struct(&pngPointer, &infoPointer);
-		return 1;
+		addSpriteSheetFrame(textureIndex, subframe, image);
+		return 0;
 	}
 
-	png_init_io(pngPointer, writeFile);
-	png_set_rows(pngPointer, infoPointer, rowPointers);
-	png_write_png(pngPointer, infoPointer, PNG_TRANSFORM_IDENTITY, NULL);
-
-	fclose(writeFile);
+	//Write to file
 
-	for (int y = 0; y < 256; y++)
+	std::string textureIndexString = std::format("{}", textureIndex);
+	if (subframe > 0)
 	{
-		delete (pixels[y]);
+		textureIndexString += std::format("-{}", subframe);
 	}
-	png_destroy_write_struct(&pngPointer, &infoPointer);
 
-	return 0;
-}
\ No newline at end of file
+	std::string textureFileName = std::format("{}-tex{}.{}", objectName, textureIndexString, textureImageSink->extension());
+
+	if (subframe == 0 && textureEmbeddingEnabled())
+		return embedTextureImage(image, textureFileName);
+
+	return exportTextureImage(image, std::format("{}{}{}", outputFolder, directorySeparator(), textureFileName));
+}
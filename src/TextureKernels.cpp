@@ -0,0 +1,239 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "TextureKernels.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TEXTURE_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_KERNELS_SSE2
+#endif
+
+// GCC and Clang need AVX2 functions marked as such, as the rest of the program isn't built for it; MSVC doesn't
+#if defined(__GNUC__) || defined(__clang__)
+#define TEXTURE_KERNELS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TEXTURE_KERNELS_TARGET_AVX2
+#endif
+
+// Scalar
+
+static inline unsigned int convertColour(unsigned short int colour)
+{
+	// Stored byte by byte, so the pixel is in RGBA order in memory on any platform
+	unsigned char bytes[4];
+	bytes[0] = (colour & 0x1F) << 3;
+	bytes[1] = ((colour >> 5) & 0x1F) << 3;
+	bytes[2] = ((colour >> 10) & 0x1F) << 3;
+	bytes[3] = colour != 0 ? 255 : 0;
+
+	unsigned int pixel;
+	std::memcpy(&pixel, bytes, 4);
+	return pixel;
+}
+
+static void convertColoursScalar(const unsigned short int* colours, unsigned int* RGBA, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		RGBA[i] = convertColour(colours[i]);
+}
+
+static void expandNibblesScalar(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount)
+{
+	for (size_t i = 0; i < VRAMPixelCount; i++)
+	{
+		indices[(i * 4)] = VRAMPixels[i] & 0x000F;
+		indices[(i * 4) + 1] = (VRAMPixels[i] & 0x00F0) >> 4;
+		indices[(i * 4) + 2] = (VRAMPixels[i] & 0x0F00) >> 8;
+		indices[(i * 4) + 3] = (VRAMPixels[i] & 0xF000) >> 12;
+	}
+}
+
+static void expandBytesScalar(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount)
+{
+	for (size_t i = 0; i < VRAMPixelCount; i++)
+	{
+		indices[(i * 2)] = VRAMPixels[i] & 0x00FF;
+		indices[(i * 2) + 1] = (VRAMPixels[i] & 0xFF00) >> 8;
+	}
+}
+
+static void lookUpPaletteScalar(const unsigned short int* indices, const unsigned int* palette, unsigned int* RGBA, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		RGBA[i] = palette[indices[i]];
+}
+
+#ifdef TEXTURE_KERNELS_SSE2
+
+// SSE2
+
+// 4 colours, already widened to 32 bits, to RGBA8 (x86 is little-endian, so red is the lowest byte)
+static inline __m128i convertColoursSSE2x4(__m128i colours)
+{
+	__m128i red = _mm_slli_epi32(_mm_and_si128(colours, _mm_set1_epi32(0x001F)), 3);
+	__m128i green = _mm_and_si128(_mm_slli_epi32(colours, 6), _mm_set1_epi32(0xF800));
+	__m128i blue = _mm_and_si128(_mm_slli_epi32(colours, 9), _mm_set1_epi32(0xF80000));
+	__m128i alpha = _mm_andnot_si128(_mm_cmpeq_epi32(colours, _mm_setzero_si128()), _mm_set1_epi32((int)0xFF000000));
+
+	return _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, alpha));
+}
+
+static void convertColoursSSE2(const unsigned short int* colours, unsigned int* RGBA, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(colours + i));
+		__m128i low = _mm_unpacklo_epi16(packed, _mm_setzero_si128());
+		__m128i high = _mm_unpackhi_epi16(packed, _mm_setzero_si128());
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(RGBA + i), convertColoursSSE2x4(low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(RGBA + i + 4), convertColoursSSE2x4(high));
+	}
+
+	convertColoursScalar(colours + i, RGBA + i, count - i);
+}
+
+static void expandNibblesSSE2(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount)
+{
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+	size_t i = 0;
+	for (; i + 8 <= VRAMPixelCount; i += 8)
+	{
+		// 16 bytes hold 32 texels, the low nibble of each byte comes first
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(VRAMPixels + i));
+		__m128i lowNibbles = _mm_and_si128(packed, nibbleMask);
+		__m128i highNibbles = _mm_and_si128(_mm_srli_epi16(packed, 4), nibbleMask);
+
+		__m128i bytesLow = _mm_unpacklo_epi8(lowNibbles, highNibbles);
+		__m128i bytesHigh = _mm_unpackhi_epi8(lowNibbles, highNibbles);
+
+		__m128i* out = reinterpret_cast<__m128i*>(indices + (i * 4));
+		_mm_storeu_si128(out, _mm_unpacklo_epi8(bytesLow, _mm_setzero_si128()));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi8(bytesLow, _mm_setzero_si128()));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi8(bytesHigh, _mm_setzero_si128()));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi8(bytesHigh, _mm_setzero_si128()));
+	}
+
+	expandNibblesScalar(VRAMPixels + i, indices + (i * 4), VRAMPixelCount - i);
+}
+
+static void expandBytesSSE2(const unsigned short int* VRAMPixels, unsigned short int* indices, size_t VRAMPixelCount)
+{
+	size_t i = 0;
+	for (; i + 8 <= VRAMPixelCount; i += 8)
+	{
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(VRAMPixels + i));
+
+		__m128i* out = reinterpret_cast<__m128i*>(indices + (i * 2));
+		_mm_storeu_si128(out, _mm_unpacklo_epi8(packed, _mm_setzero_si128()));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi8(packed, _mm_setzero_si128()));
+	}
+
+	expandBytesScalar(VRAMPixels + i, indices + (i * 2), VRAMPixelCount - i);
+}
+
+// SSE2 has no gather, so the palette lookup stays scalar
+
+// AVX2
+
+TEXTURE_KERNELS_TARGET_AVX2
+static void convertColoursAVX2(const unsigned short int* colours, unsigned int* RGBA, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(colours + i)));
+
+		__m256i red = _mm256_slli_epi32(_mm256_and_si256(widened, _mm256_set1_epi32(0x001F)), 3);
+		__m256i green = _mm256_and_si256(_mm256_slli_epi32(widened, 6), _mm256_set1_epi32(0xF800));
+		__m256i blue = _mm256_and_si256(_mm256_slli_epi32(widened, 9), _mm256_set1_epi32(0xF80000));
+		__m256i alpha = _mm256_andnot_si256(_mm256_cmpeq_epi32(widened, _mm256_setzero_si256()), _mm256_set1_epi32((int)0xFF000000));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(RGBA + i), _mm256_or_si256(_mm256_or_si256(red, green), _mm256_or_si256(blue, alpha)));
+	}
+
+	convertColoursScalar(colours + i, RGBA + i, count - i);
+}
+
+TEXTURE_KERNELS_TARGET_AVX2
+static void lookUpPaletteAVX2(const unsigned short int* indices, const unsigned int* palette, unsigned int* RGBA, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i widened = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)));
+		__m256i pixels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), widened, 4);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(RGBA + i), pixels);
+	}
+
+	lookUpPaletteScalar(indices + i, palette, RGBA + i, count - i);
+}
+
+#endif
+
+static bool CPUSupportsAVX2()
+{
+#if defined(TEXTURE_KERNELS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(TEXTURE_KERNELS_SSE2) && defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 0);
+	if (cpuInfo[0] < 7)
+		return false;
+
+	// The OS also has to save the AVX registers
+	__cpuid(cpuInfo, 1);
+	bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+	bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(cpuInfo, 7, 0);
+	return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+static TextureKernels selectTextureKernels()
+{
+#ifdef TEXTURE_KERNELS_SSE2
+	if (CPUSupportsAVX2())
+		return { convertColoursAVX2, expandNibblesSSE2, expandBytesSSE2, lookUpPaletteAVX2, "AVX2" };
+
+	return { convertColoursSSE2, expandNibblesSSE2, expandBytesSSE2, lookUpPaletteScalar, "SSE2" };
+#else
+	return { convertColoursScalar, expandNibblesScalar, expandBytesScalar, lookUpPaletteScalar, "scalar" };
+#endif
+}
+
+const TextureKernels& textureKernels()
+{
+	static const TextureKernels kernels = selectTextureKernels();
+	return kernels;
+}
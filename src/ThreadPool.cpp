@@ -0,0 +1,80 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int workerCount, size_t maxQueuedJobs) : maxQueuedJobs(maxQueuedJobs)
+{
+	for (unsigned int i = 0; i < workerCount; i++)
+		workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+
+	// Workers finish the jobs that are already queued before they stop
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		spaceAvailable.wait(lock, [this] { return jobs.size() < maxQueuedJobs; });
+		jobs.push_back(std::move(job));
+		unfinishedJobs++;
+	}
+	jobAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	allJobsFinished.wait(lock, [this] { return unfinishedJobs == 0; });
+}
+
+void ThreadPool::work()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		spaceAvailable.notify_one();
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			unfinishedJobs--;
+			if (unfinishedJobs == 0)
+				allJobsFinished.notify_all();
+		}
+	}
+}
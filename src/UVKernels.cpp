@@ -0,0 +1,103 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "UVKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UV_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(UV) == sizeof(float) * 2, "UVs must be packed as pairs of floats");
+
+UVBounds findUVBounds(const UV* UVs, size_t count)
+{
+	UVBounds bounds = { UVs[0].u, UVs[0].u, UVs[0].v, UVs[0].v };
+	size_t i = 0;
+
+#ifdef UV_KERNELS_SSE2
+	// Two UVs per register, laid out as u, v, u, v
+	if (count >= 2)
+	{
+		const float* floats = reinterpret_cast<const float*>(UVs);
+		__m128 minimum = _mm_loadu_ps(floats);
+		__m128 maximum = minimum;
+
+		for (i = 2; i + 2 <= count; i += 2)
+		{
+			__m128 pair = _mm_loadu_ps(floats + (i * 2));
+			minimum = _mm_min_ps(minimum, pair);
+			maximum = _mm_max_ps(maximum, pair);
+		}
+
+		// Fold the second UV's lanes onto the first's
+		minimum = _mm_min_ps(minimum, _mm_movehl_ps(minimum, minimum));
+		maximum = _mm_max_ps(maximum, _mm_movehl_ps(maximum, maximum));
+
+		alignas(16) float minimums[4];
+		alignas(16) float maximums[4];
+		_mm_store_ps(minimums, minimum);
+		_mm_store_ps(maximums, maximum);
+
+		bounds = { minimums[0], maximums[0], minimums[1], maximums[1] };
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (UVs[i].u < bounds.left)
+			bounds.left = UVs[i].u;
+		if (UVs[i].u > bounds.right)
+			bounds.right = UVs[i].u;
+		if (UVs[i].v < bounds.south)
+			bounds.south = UVs[i].v;
+		if (UVs[i].v > bounds.north)
+			bounds.north = UVs[i].v;
+	}
+
+	return bounds;
+}
+
+void normaliseUVs(UV* UVs, size_t count, const UVBounds& bounds)
+{
+	float stretchInU = 1.0f / (bounds.right - bounds.left);
+	float stretchInV = 1.0f / (bounds.north - bounds.south);
+	if (bounds.right - bounds.left == 0)
+		stretchInU = 0.0f;
+	if (bounds.north - bounds.south == 0)
+		stretchInV = 0.0f;
+
+	size_t i = 0;
+
+#ifdef UV_KERNELS_SSE2
+	float* floats = reinterpret_cast<float*>(UVs);
+	const __m128 translation = _mm_setr_ps(bounds.left, bounds.south, bounds.left, bounds.south);
+	const __m128 stretch = _mm_setr_ps(stretchInU, stretchInV, stretchInU, stretchInV);
+
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128 pair = _mm_loadu_ps(floats + (i * 2));
+		pair = _mm_mul_ps(_mm_sub_ps(pair, translation), stretch);
+		_mm_storeu_ps(floats + (i * 2), pair);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		UVs[i].u = (UVs[i].u - bounds.left) * stretchInU;
+		UVs[i].v = (UVs[i].v - bounds.south) * stretchInV;
+	}
+}
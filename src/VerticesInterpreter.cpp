@@ -14,22 +14,18 @@
     You should have received a copy of the GNU General Public License
     along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
 
-#include <fstream>
-
 #include "VerticesInterpreter.h"
 
-void readVertices(std::ifstream& reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
+void readVertices(BinaryCursor reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
     unsigned int boneStartAddress, bool isObject, std::vector<Vertex>& vertices)
 {
 	if (vertexStartAddress == 0 || vertexCount == 0) { return; }
 
-	reader.seekg(vertexStartAddress, reader.beg);
+	vertices.reserve(vertexCount);
 
 	for (unsigned int v = 0; v < vertexCount; v++)
 	{
-		unsigned int uPolygonPosition = reader.tellg();
-		vertices.push_back(readVertex(reader, v));
-		reader.seekg(uPolygonPosition + 0xC, reader.beg);
+		vertices.push_back(readVertex(reader.at(vertexStartAddress + (v * 0xC)), v));
 	}
 
 	if (isObject)
@@ -38,23 +34,19 @@ void readVertices(std::ifstream& reader, unsigned short int vertexCount, unsigne
 
 		readArmature(reader, boneCount, boneStartAddress, bones);
 
-		applyArmature(reader, vertexCount, vertexStartAddress, boneCount, boneStartAddress, vertices, bones);
+		applyArmature(vertexCount, vertexStartAddress, boneCount, boneStartAddress, vertices, bones);
 	}
 }
 
-Vertex readVertex(std::ifstream& reader, unsigned int v)
+Vertex readVertex(BinaryCursor reader, unsigned int v)
 {
 	Vertex thisVertex;
 
 	thisVertex.positionID = v;
 
-	short int x;
-	short int y;
-	short int z;
-
-	reader.read((char*)&x, 2);
-	reader.read((char*)&y, 2);
-	reader.read((char*)&z, 2);
+	short int x = reader.read<short int>();
+	short int y = reader.read<short int>();
+	short int z = reader.read<short int>();
 
 	thisVertex.rawX = x;
 	thisVertex.rawY = y;
@@ -63,7 +55,7 @@ Vertex readVertex(std::ifstream& reader, unsigned int v)
 	thisVertex.finalY = y;
 	thisVertex.finalZ = z;
 
-	reader.read((char*)&thisVertex.normalID, 2);
+	thisVertex.normalID = reader.read<unsigned short int>();
 
 	return thisVertex;
 }
@@ -71,12 +63,10 @@ Vertex readVertex(std::ifstream& reader, unsigned int v)
 
 
 
-void readArmature(std::ifstream &reader, unsigned short int boneCount, unsigned int boneStartAddress, std::vector<Bone>& bones)
+void readArmature(BinaryCursor reader, unsigned short int boneCount, unsigned int boneStartAddress, std::vector<Bone>& bones)
 {
 	if (boneStartAddress == 0 || boneCount == 0) { return; }
 
-	reader.seekg(boneStartAddress, reader.beg);
-
 	for (unsigned short int b = 0; b < boneCount; b++)
 	{
 		// Slightly hacky solution for creating a vector with the needed size
@@ -90,14 +80,14 @@ void readArmature(std::ifstream &reader, unsigned short int boneCount, unsigned
 
 	for (unsigned short int b = 0; b < boneCount; b++)
 	{
-		reader.seekg(8, reader.cur);
+		BinaryCursor boneReader = reader.at(boneStartAddress + (b * 0x18) + 8);
 
-		reader.read((char*)&bones[b].vFirst, sizeof(bones[b].vFirst));
-		reader.read((char*)&bones[b].vLast, sizeof(bones[b].vLast));
-		reader.read((char*)&bones[b].localX, 2);
-		reader.read((char*)&bones[b].localY, 2);
-		reader.read((char*)&bones[b].localZ, 2);
-		reader.read((char*)&bones[b].parentID, sizeof(bones[b].parentID));
+		bones[b].vFirst = boneReader.read<unsigned short int>();
+		bones[b].vLast = boneReader.read<unsigned short int>();
+		bones[b].localX = boneReader.read<short int>();
+		bones[b].localY = boneReader.read<short int>();
+		bones[b].localZ = boneReader.read<short int>();
+		bones[b].parentID = boneReader.read<unsigned short int>();
 
 		bones[b].worldX = 0.0f;
 		bones[b].worldY = 0.0f;
@@ -114,12 +104,10 @@ void readArmature(std::ifstream &reader, unsigned short int boneCount, unsigned
 				ancestorID = bones[ancestorID].parentID;
 			}
 		}
-
-		reader.seekg(4, reader.cur);
 	}
 }
 
-void applyArmature(std::ifstream& reader, unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
+void applyArmature(unsigned short int vertexCount, unsigned int vertexStartAddress, unsigned short int boneCount,
     unsigned int boneStartAddress, std::vector<Vertex>& vertices, std::vector<Bone>& bones)
 {
 	if (vertexStartAddress == 0 || vertexCount == 0 || boneStartAddress == 0 || boneCount == 0) { return; }
@@ -1,13 +1,27 @@
 #include "XMLExport.h"
 #include "SharedFunctions.h"
+#include "TextureExporter.h"
+#include "TextureAtlas.h"
+#include "NumberFormat.h"
 
 #include <format>
 #include <string>
 #include <filesystem>
+#include <cstring>
+#include <unordered_map>
 
-int exportToXML(std::string outputFolder, std::string objectName, std::vector<PolygonStruct>& polygons, std::vector<Material>& materials)
+// Name of the effect a material uses, which real materials share in atlas mode
+static std::string materialEffectName(std::string objectName, const Material& material, int materialID)
 {
-    // This stuff is mostly just interfacing with tinyxml2, not really too much to say here
+    if (textureAtlasEnabled() && material.realMaterial)
+        return std::format("{}-atlas", objectName);
+
+    return std::format("{}-{}", objectName, materialID);
+}
+
+int exportToXML(std::string outputFolder, std::string objectName, Mesh& modelMesh, std::vector<Material>& materials)
+{
+	// The document is written in order as it goes, so each library goes through all of the materials in turn
 
 	int returnValue = 0;
 
@@ -17,111 +31,125 @@ int exportToXML(std::string outputFolder, std::string objectName, std::vector<Po
 	timePointer = localtime(&currentTime);
 	strftime(timeString, 100, "%FT%T", timePointer);
 
-	tinyxml2::XMLDocument outputDAE;
-
-	tinyxml2::XMLDeclaration* header = outputDAE.NewDeclaration("xml version = \"1.0\" encoding = \"UTF-8\" standalone = \"no\"");
-	outputDAE.LinkEndChild(header);
-
-	tinyxml2::XMLElement* rootNode = outputDAE.NewElement("COLLADA");
-	rootNode->SetAttribute("xmlns", "http://www.collada.org/2005/11/COLLADASchema");
-	rootNode->SetAttribute("version", "1.4.1");
-	tinyxml2::XMLElement* asset = outputDAE.NewElement("asset");
-	tinyxml2::XMLElement* contributor = outputDAE.NewElement("contributor");
-	tinyxml2::XMLElement* author = outputDAE.NewElement("author");
-	author->SetText("Crystal Dynamics");
-	tinyxml2::XMLElement* authoring_tool = outputDAE.NewElement("authoring_tool");
-	authoring_tool->SetText("Gex 2 PS1 Model Exporter");
-	contributor->LinkEndChild(author);
-	contributor->LinkEndChild(authoring_tool);
-	tinyxml2::XMLElement* creationDate = outputDAE.NewElement("created");
-	creationDate->SetText(timeString);
-	tinyxml2::XMLElement* modifiedDate = outputDAE.NewElement("modified");
-	modifiedDate->SetText(timeString);
-	tinyxml2::XMLElement* unit = outputDAE.NewElement("unit");
-	unit->SetAttribute("name", "meter");
-	unit->SetAttribute("meter", "1");
-	tinyxml2::XMLElement* up_axis = outputDAE.NewElement("up_axis");
-	up_axis->SetText("Z_UP");
-	asset->LinkEndChild(contributor);
-	asset->LinkEndChild(creationDate);
-	asset->LinkEndChild(modifiedDate);
-	asset->LinkEndChild(unit);
-	asset->LinkEndChild(up_axis);
-	rootNode->LinkEndChild(asset);
-
-	tinyxml2::XMLElement* library_images = outputDAE.NewElement("library_images");
-	tinyxml2::XMLElement* library_effects = outputDAE.NewElement("library_effects");
-	tinyxml2::XMLElement* library_materials = outputDAE.NewElement("library_materials");
-	tinyxml2::XMLElement* library_geometries = outputDAE.NewElement("library_geometries");
-
-	tinyxml2::XMLElement* library_visual_scenes = outputDAE.NewElement("library_visual_scenes");
-	tinyxml2::XMLElement* visual_scene = outputDAE.NewElement("visual_scene");
-	visual_scene->SetAttribute("id", objectName.c_str());
-	visual_scene->SetAttribute("name", objectName.c_str());
-	tinyxml2::XMLElement* nodeArmature = outputDAE.NewElement("node");
-	nodeArmature->SetAttribute("id", std::format("{}node", objectName).c_str());
-	nodeArmature->SetAttribute("name", objectName.c_str());
-	nodeArmature->SetAttribute("type", "NODE");
-	tinyxml2::XMLElement* matrixArmature = outputDAE.NewElement("matrix");
-	matrixArmature->SetAttribute("sid", "matrix");
-	matrixArmature->SetText("1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1");
-	tinyxml2::XMLElement* nodeModel = outputDAE.NewElement("node");
-	nodeModel->SetAttribute("id", std::format("{}node0", objectName).c_str());
-	nodeModel->SetAttribute("name", objectName.c_str());
-	nodeModel->SetAttribute("type", "NODE");
-	tinyxml2::XMLElement* matrixModel = outputDAE.NewElement("matrix");
-	matrixModel->SetAttribute("sid", "matrix");
-	matrixModel->SetText("1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1");
-	nodeModel->LinkEndChild(matrixModel);
-
-    for (int m = 0; m < materials.size(); m++)
+	if (!std::filesystem::exists(outputFolder))
+		return 2;
+
+	XMLWriter outputDAE;
+	if (!outputDAE.open(std::format("{}{}{}.dae", outputFolder, directorySeparator(), objectName)))
+		return 2;
+
+	outputDAE.declaration("xml version = \"1.0\" encoding = \"UTF-8\" standalone = \"no\"");
+
+	outputDAE.openElement("COLLADA");
+	outputDAE.attribute("xmlns", "http://www.collada.org/2005/11/COLLADASchema");
+	outputDAE.attribute("version", "1.4.1");
+
+	outputDAE.openElement("asset");
+	outputDAE.openElement("contributor");
+	outputDAE.textElement("author", "Crystal Dynamics");
+	outputDAE.textElement("authoring_tool", "Gex 2 PS1 Model Exporter");
+	outputDAE.closeElement();
+	outputDAE.textElement("created", timeString);
+	outputDAE.textElement("modified", timeString);
+	outputDAE.openElement("unit");
+	outputDAE.attribute("name", "meter");
+	outputDAE.attribute("meter", "1");
+	outputDAE.closeElement();
+	outputDAE.textElement("up_axis", "Z_UP");
+	outputDAE.closeElement();
+
+	// With a texture atlas, every real material shares the one image and effect
+	bool useAtlas = textureAtlasEnabled();
+	std::string atlasName = std::format("{}-atlas", objectName);
+	const Material* atlasMaterial = nullptr;
+	if (useAtlas)
 	{
-		if (!materials[m].properlyExported)
-			returnValue = 1;
-
-        std::vector<PolygonStruct> meshPolygons;
-		std::vector<Vertex> meshVertices;
-        tinyxml2::XMLElement* xmlMaterial = outputDAE.NewElement("material");
-        tinyxml2::XMLElement* xmlGeometry = outputDAE.NewElement("geometry");
-        tinyxml2::XMLElement* xmlMesh = outputDAE.NewElement("mesh");
-
-        exportTexture(outputDAE, library_images, materials[m], objectName);
-
-        exportEffect(outputDAE, library_effects, materials[m], m, objectName);
-
-        exportMaterial(outputDAE, xmlMaterial, library_materials, materials[m], m, objectName);
-
-        // Geometry export includes positions, textures, colours, vertices, and polygons
-        exportGeometry(outputDAE, polygons, xmlGeometry, xmlMesh, library_geometries, meshPolygons, meshVertices, materials[m], m, objectName);
-
-        exportVisualScene(outputDAE, nodeModel, m, objectName);
-    }
-
-    rootNode->LinkEndChild(library_images);
-	rootNode->LinkEndChild(library_effects);
-	rootNode->LinkEndChild(library_materials);
-	rootNode->LinkEndChild(library_geometries);
-
-	nodeArmature->LinkEndChild(matrixArmature);
-	nodeArmature->LinkEndChild(nodeModel);
-	visual_scene->LinkEndChild(nodeArmature);
-	library_visual_scenes->LinkEndChild(visual_scene);
-	rootNode->LinkEndChild(library_visual_scenes);
-
+		for (const Material& material : materials)
+		{
+			if (material.realMaterial && material.properlyExported)
+			{
+				atlasMaterial = &material;
+				break;
+			}
+		}
+	}
 
-	tinyxml2::XMLElement* scene = outputDAE.NewElement("scene");
-	tinyxml2::XMLElement* instance_visual_scene = outputDAE.NewElement("instance_visual_scene");
-	instance_visual_scene->SetAttribute("url", std::format("#{}", objectName).c_str());
-	scene->LinkEndChild(instance_visual_scene);
-	rootNode->LinkEndChild(scene);
+	outputDAE.openElement("library_images");
+	if (atlasMaterial)
+		exportTexture(outputDAE, *atlasMaterial, atlasName, textureAtlasFileName(objectName));
+	for (unsigned int m = 0; m < materials.size(); m++)
+	{
+		if (!useAtlas || !materials[m].realMaterial)
+		{
+			exportTexture(outputDAE, materials[m], std::format("{}-{}", objectName, materials[m].textureID),
+				std::format("{}-tex{}.{}", objectName, materials[m].textureID + 1, textureImageExtension()));
+		}
+	}
+	outputDAE.closeElement();
 
-	outputDAE.LinkEndChild(rootNode);
+	outputDAE.openElement("library_effects");
+	if (atlasMaterial)
+		exportEffect(outputDAE, *atlasMaterial, atlasName, atlasName);
+	for (unsigned int m = 0; m < materials.size(); m++)
+	{
+		if (!useAtlas || !materials[m].realMaterial)
+			exportEffect(outputDAE, materials[m], materialEffectName(objectName, materials[m], m), std::format("{}-{}", objectName, materials[m].textureID));
+	}
+	outputDAE.closeElement();
 
-	if (std::filesystem::exists(outputFolder))
+	outputDAE.openElement("library_materials");
+	for (unsigned int m = 0; m < materials.size(); m++)
 	{
-        if (outputDAE.SaveFile(std::format("{}{}{}.dae", outputFolder, directorySeparator(), objectName).c_str()) == 0)
-		    return returnValue;
+		if (!materials[m].properlyExported)
+			returnValue = 1;
+
+		exportMaterial(outputDAE, materials[m], m, materialEffectName(objectName, materials[m], m), objectName);
 	}
+	outputDAE.closeElement();
+
+	// Geometry export includes positions, textures, colours, vertices, and polygons
+	outputDAE.openElement("library_geometries");
+	for (unsigned int m = 0; m < materials.size(); m++)
+		exportGeometry(outputDAE, modelMesh, materials[m], m, objectName);
+	outputDAE.closeElement();
+
+	outputDAE.openElement("library_visual_scenes");
+	outputDAE.openElement("visual_scene");
+	outputDAE.attribute("id", objectName);
+	outputDAE.attribute("name", objectName);
+	outputDAE.openElement("node");
+	outputDAE.attribute("id", std::format("{}node", objectName));
+	outputDAE.attribute("name", objectName);
+	outputDAE.attribute("type", "NODE");
+	outputDAE.openElement("matrix");
+	outputDAE.attribute("sid", "matrix");
+	outputDAE.text("1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1");
+	outputDAE.closeElement();
+	outputDAE.openElement("node");
+	outputDAE.attribute("id", std::format("{}node0", objectName));
+	outputDAE.attribute("name", objectName);
+	outputDAE.attribute("type", "NODE");
+	outputDAE.openElement("matrix");
+	outputDAE.attribute("sid", "matrix");
+	outputDAE.text("1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1");
+	outputDAE.closeElement();
+	for (unsigned int m = 0; m < materials.size(); m++)
+		exportVisualScene(outputDAE, m, objectName);
+	outputDAE.closeElement();
+	outputDAE.closeElement();
+	outputDAE.closeElement();
+	outputDAE.closeElement();
+
+	outputDAE.openElement("scene");
+	outputDAE.openElement("instance_visual_scene");
+	outputDAE.attribute("url", std::format("#{}", objectName));
+	outputDAE.closeElement();
+	outputDAE.closeElement();
+
+	outputDAE.closeElement();
+
+	if (outputDAE.close())
+		return returnValue;
 
 	// Could not export
 	return 2;
@@ -129,357 +157,358 @@ int exportToXML(std::string outputFolder, std::string objectName, std::vector<Po
 
 
 
-int exportTexture(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* library_images, Material exportMaterial, std::string objectName)
+int exportTexture(XMLWriter& outputDAE, Material exportMaterial, std::string textureName, std::string textureFileName)
 {
     if (exportMaterial.realMaterial && exportMaterial.properlyExported)
     {
-        tinyxml2::XMLElement* image = outputDAE.NewElement("image");
-        image->SetAttribute("id", std::format("{}-{}-diffuse-image", objectName, exportMaterial.textureID).c_str());
-        tinyxml2::XMLElement* init_fromDiffuseImage = outputDAE.NewElement("init_from");
-        init_fromDiffuseImage->SetText(std::format("{}-tex{}.png", objectName, exportMaterial.textureID + 1).c_str());
-        image->LinkEndChild(init_fromDiffuseImage);
-        library_images->LinkEndChild(image);
+        outputDAE.openElement("image");
+        outputDAE.attribute("id", std::format("{}-diffuse-image", textureName));
+        outputDAE.textElement("init_from", textureFileName);
+        outputDAE.closeElement();
     }
 
     return 0;
 }
 
-int exportEffect(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* library_effects, Material exportMaterial, int materialID, std::string objectName)
+int exportEffect(XMLWriter& outputDAE, Material exportMaterial, std::string effectName, std::string textureName)
 {
     if (exportMaterial.properlyExported)
     {
-        tinyxml2::XMLElement* effect = outputDAE.NewElement("effect");
-        effect->SetAttribute("id", std::format("{}-{}-fx", objectName, materialID).c_str());
-        effect->SetAttribute("name", std::format("{}-{}", objectName, materialID).c_str());
-        tinyxml2::XMLElement* profile_COMMON = outputDAE.NewElement("profile_COMMON");
+        outputDAE.openElement("effect");
+        outputDAE.attribute("id", std::format("{}-fx", effectName));
+        outputDAE.attribute("name", effectName);
+        outputDAE.openElement("profile_COMMON");
 
         if (exportMaterial.realMaterial)
         {
-            tinyxml2::XMLElement* newparamSurface = outputDAE.NewElement("newparam");
-            newparamSurface->SetAttribute("sid", std::format("{}-{}-diffuse-surface", objectName, exportMaterial.textureID).c_str());
-            tinyxml2::XMLElement* surface = outputDAE.NewElement("surface");
-            surface->SetAttribute("type", "2D");
-            tinyxml2::XMLElement* init_fromDiffuseSurface = outputDAE.NewElement("init_from");
-            init_fromDiffuseSurface->SetText(std::format("{}-{}-diffuse-image", objectName, exportMaterial.textureID).c_str());
-            surface->LinkEndChild(init_fromDiffuseSurface);
-            newparamSurface->LinkEndChild(surface);
-            profile_COMMON->LinkEndChild(newparamSurface);
-
-            tinyxml2::XMLElement* newparamSampler = outputDAE.NewElement("newparam");
-            newparamSampler->SetAttribute("sid", std::format("{}-{}-diffuse-sampler", objectName, exportMaterial.textureID).c_str());
-            tinyxml2::XMLElement* sampler2D = outputDAE.NewElement("sampler2D");
-            tinyxml2::XMLElement* samplerSource = outputDAE.NewElement("source");
-            samplerSource->SetText(std::format("{}-{}-diffuse-surface", objectName, exportMaterial.textureID).c_str());
-            sampler2D->LinkEndChild(samplerSource);
-            newparamSampler->LinkEndChild(sampler2D);
-            profile_COMMON->LinkEndChild(newparamSampler);
+            outputDAE.openElement("newparam");
+            outputDAE.attribute("sid", std::format("{}-diffuse-surface", textureName));
+            outputDAE.openElement("surface");
+            outputDAE.attribute("type", "2D");
+            outputDAE.textElement("init_from", std::format("{}-diffuse-image", textureName));
+            outputDAE.closeElement();
+            outputDAE.closeElement();
+
+            outputDAE.openElement("newparam");
+            outputDAE.attribute("sid", std::format("{}-diffuse-sampler", textureName));
+            outputDAE.openElement("sampler2D");
+            outputDAE.textElement("source", std::format("{}-diffuse-surface", textureName));
+            outputDAE.closeElement();
+            outputDAE.closeElement();
         }
 
-        tinyxml2::XMLElement* technique = outputDAE.NewElement("technique");
-        technique->SetAttribute("sid", "standard");
-        tinyxml2::XMLElement* phong = outputDAE.NewElement("phong");
-        tinyxml2::XMLElement* diffuse = outputDAE.NewElement("diffuse");
+        outputDAE.openElement("technique");
+        outputDAE.attribute("sid", "standard");
+        outputDAE.openElement("phong");
+        outputDAE.openElement("diffuse");
 
         if (exportMaterial.realMaterial)
         {
-            tinyxml2::XMLElement* texture = outputDAE.NewElement("texture");
-            texture->SetAttribute("texture", std::format("{}-{}-diffuse-sampler", objectName, exportMaterial.textureID).c_str());
-            texture->SetAttribute("texcoord", "CHANNEL0");
-            diffuse->LinkEndChild(texture);
+            outputDAE.openElement("texture");
+            outputDAE.attribute("texture", std::format("{}-diffuse-sampler", textureName));
+            outputDAE.attribute("texcoord", "CHANNEL0");
+            outputDAE.closeElement();
         }
         else
         {
-            std::string coloursString = "";
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.redVal) / 1.25f) + " ";
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.greenVal) / 1.25f) + " ";
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.blueVal) / 1.25f) + " ";
-            coloursString += "1";
-
-            tinyxml2::XMLElement* colour = outputDAE.NewElement("color");
-            colour->SetAttribute("sid", "diffuse");
-            colour->SetText(coloursString.c_str());
-            diffuse->LinkEndChild(colour);
+            outputDAE.openElement("color");
+            outputDAE.attribute("sid", "diffuse");
+            char* coloursText = outputDAE.beginTextInPlace(3 * (maxFormattedNumberLength + 1) + 1);
+            for (unsigned char colour : { exportMaterial.redVal, exportMaterial.greenVal, exportMaterial.blueVal })
+            {
+                coloursText = formatFloatFixed(coloursText, rgbToLinearRgb(colour) / 1.25f);
+                *coloursText++ = ' ';
+            }
+            *coloursText++ = '1';
+            outputDAE.endTextInPlace(coloursText);
+            outputDAE.closeElement();
         }
-        phong->LinkEndChild(diffuse);
-        tinyxml2::XMLElement* specular = outputDAE.NewElement("specular");
-        tinyxml2::XMLElement* specularColour = outputDAE.NewElement("color");
-        specularColour->SetAttribute("sid", "specular");
-        specularColour->SetText("0   0   0   0");
-        specular->LinkEndChild(specularColour);
-        phong->LinkEndChild(specular);
-        tinyxml2::XMLElement* transparency = outputDAE.NewElement("transparency");
-        tinyxml2::XMLElement* transparencyFloat = outputDAE.NewElement("float");
-        transparencyFloat->SetAttribute("sid", "transparency");
-        transparencyFloat->SetText("1");
-        transparency->LinkEndChild(transparencyFloat);
-        phong->LinkEndChild(transparency);
-        technique->LinkEndChild(phong);
-        profile_COMMON->LinkEndChild(technique);
-
-        effect->LinkEndChild(profile_COMMON);
-        library_effects->LinkEndChild(effect);
+        outputDAE.closeElement();
+
+        outputDAE.openElement("specular");
+        outputDAE.openElement("color");
+        outputDAE.attribute("sid", "specular");
+        outputDAE.text("0   0   0   0");
+        outputDAE.closeElement();
+        outputDAE.closeElement();
+
+        outputDAE.openElement("transparency");
+        outputDAE.openElement("float");
+        outputDAE.attribute("sid", "transparency");
+        outputDAE.text("1");
+        outputDAE.closeElement();
+        outputDAE.closeElement();
+
+        outputDAE.closeElement();
+        outputDAE.closeElement();
+        outputDAE.closeElement();
+        outputDAE.closeElement();
     }
 
     return 0;
 }
 
-int exportMaterial(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* material, tinyxml2::XMLElement* library_materials,
-    Material exportMaterial, int materialID, std::string objectName)
+int exportMaterial(XMLWriter& outputDAE, Material exportMaterial, int materialID, std::string effectName, std::string objectName)
 {
-    material->SetAttribute("id", std::format("{}-mat{}", objectName, materialID).c_str());
-    material->SetAttribute("name", std::format("{}-mat{}", objectName, materialID).c_str());
+    outputDAE.openElement("material");
+    outputDAE.attribute("id", std::format("{}-mat{}", objectName, materialID));
+    outputDAE.attribute("name", std::format("{}-mat{}", objectName, materialID));
     if (exportMaterial.properlyExported)
     {
-        tinyxml2::XMLElement* instance_effectMaterial = outputDAE.NewElement("instance_effect");
-        instance_effectMaterial->SetAttribute("url", std::format("#{}-{}-fx", objectName, materialID).c_str());
-        material->LinkEndChild(instance_effectMaterial);
+        outputDAE.openElement("instance_effect");
+        outputDAE.attribute("url", std::format("#{}-fx", effectName));
+        outputDAE.closeElement();
     }
-    library_materials->LinkEndChild(material);
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportGeometry(tinyxml2::XMLDocument& outputDAE, std::vector<PolygonStruct>& polygons, tinyxml2::XMLElement* geometry, tinyxml2::XMLElement* mesh,
-    tinyxml2::XMLElement* library_geometries, std::vector<PolygonStruct>& meshPolygons, std::vector<Vertex>& meshVertices, Material exportMaterial, int materialID,
-    std::string objectName)
+int exportGeometry(XMLWriter& outputDAE, Mesh& modelMesh, Material exportMaterial, int materialID, std::string objectName)
 {
-    for (int p = 0; p < polygons.size(); p++)
-    {
-        if (polygons[p].materialID == materialID)
-        {
-            meshPolygons.push_back(polygons[p]);
-            meshVertices.push_back(polygons[p].v1);
-            meshVertices.push_back(polygons[p].v2);
-            meshVertices.push_back(polygons[p].v3);
-        }
-    }
+    // The polygons are grouped by material, so this material's polygons are read straight from its range of the model's mesh
+    outputDAE.openElement("geometry");
+    outputDAE.attribute("id", std::format("meshId{}", materialID));
+    outputDAE.attribute("name", std::format("meshId{}_name", materialID));
+    outputDAE.openElement("mesh");
 
-    geometry->SetAttribute("id", std::format("meshId{}", materialID).c_str());
-    geometry->SetAttribute("name", std::format("meshId{}_name", materialID).c_str());
+    WeldedCorners weldedCorners = weldCorners(modelMesh, exportMaterial);
 
-    exportPositions(outputDAE, mesh, meshPolygons, meshVertices, materialID);
+    exportPositions(outputDAE, weldedCorners, materialID);
 
-    exportTextures(outputDAE, mesh, meshPolygons, materialID);
+    exportTextures(outputDAE, weldedCorners, materialID);
 
-    exportColours(outputDAE, mesh, meshPolygons, exportMaterial, materialID);
+    exportColours(outputDAE, exportMaterial, materialID);
 
-    exportVertices(outputDAE, mesh, materialID);
+    exportVertices(outputDAE, materialID);
 
-    exportPolygons(outputDAE, mesh, meshPolygons.size(), materialID);
+    exportPolygons(outputDAE, weldedCorners, exportMaterial.polygonCount, materialID);
 
-    geometry->LinkEndChild(mesh);
-    library_geometries->LinkEndChild(geometry);
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportPositions(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh,
-    std::vector<PolygonStruct>& meshPolygons, std::vector<Vertex>& meshVertices, int materialID)
+// The parameters of an accessor, which are all floats
+static void exportAccessorParams(XMLWriter& outputDAE, std::initializer_list<const char*> paramNames)
 {
-    tinyxml2::XMLElement* positionsSource = outputDAE.NewElement("source");
-    positionsSource->SetAttribute("id", std::format("meshId{}-positions", materialID).c_str());
-    positionsSource->SetAttribute("name", std::format("meshId{}-positions", materialID).c_str());
-    tinyxml2::XMLElement* positionsFloat_array = outputDAE.NewElement("float_array");
-    positionsFloat_array->SetAttribute("id", std::format("meshId{}-positions-array", materialID).c_str());
-    positionsFloat_array->SetAttribute("count", meshPolygons.size() * 9);
-    std::string positionsString = " ";
-    for (int v = 0; v < meshVertices.size(); v++)
+    for (const char* paramName : paramNames)
     {
-        positionsString += std::format("{} ", divideByAPowerOfTen(meshVertices[v].finalX, 3));
-        positionsString += std::format("{} ", divideByAPowerOfTen(meshVertices[v].finalY, 3));
-        positionsString += std::format("{} ", divideByAPowerOfTen(meshVertices[v].finalZ, 3));
+        outputDAE.openElement("param");
+        outputDAE.attribute("name", paramName);
+        outputDAE.attribute("type", "float");
+        outputDAE.closeElement();
     }
-    positionsFloat_array->SetText(positionsString.c_str());
-    tinyxml2::XMLElement* positionsTechnique_common = outputDAE.NewElement("technique_common");
-    tinyxml2::XMLElement* positionsAccessor = outputDAE.NewElement("accessor");
-    positionsAccessor->SetAttribute("count", meshPolygons.size() * 3);
-    positionsAccessor->SetAttribute("offset", 0);
-    positionsAccessor->SetAttribute("source", std::format("#meshId{}-positions-array", materialID).c_str());
-    positionsAccessor->SetAttribute("stride", 3);
-    tinyxml2::XMLElement* paramX = outputDAE.NewElement("param");
-    paramX->SetAttribute("name", "X");
-    paramX->SetAttribute("type", "float");
-    tinyxml2::XMLElement* paramY = outputDAE.NewElement("param");
-    paramY->SetAttribute("name", "Y");
-    paramY->SetAttribute("type", "float");
-    tinyxml2::XMLElement* paramZ = outputDAE.NewElement("param");
-    paramZ->SetAttribute("name", "Z");
-    paramZ->SetAttribute("type", "float");
-
-    positionsAccessor->LinkEndChild(paramX);
-    positionsAccessor->LinkEndChild(paramY);
-    positionsAccessor->LinkEndChild(paramZ);
-    positionsTechnique_common->LinkEndChild(positionsAccessor);
-    positionsSource->LinkEndChild(positionsFloat_array);
-    positionsSource->LinkEndChild(positionsTechnique_common);
-    mesh->LinkEndChild(positionsSource);
+}
+
+WeldedCorners weldCorners(Mesh& modelMesh, Material exportMaterial)
+{
+    WeldedCorners weldedCorners;
+    weldedCorners.cornerIndices.reserve(exportMaterial.polygonCount * 6);
+
+    // Positions are keyed by their three 16 bit coordinates, and UVs by the bits of their U and V
+    std::unordered_map<unsigned long long int, int> positionIndices;
+    std::unordered_map<unsigned long long int, int> UVIndices;
+
+    for (unsigned int p = exportMaterial.polygonStart; p < exportMaterial.polygonStart + exportMaterial.polygonCount; p++)
+    {
+        const PolygonStruct& polygon = modelMesh.polygons[p];
+        unsigned int c = p * 3;
+        for (const unsigned short int& vertexID : { polygon.v1, polygon.v2, polygon.v3 })
+        {
+            const Vertex& vertex = modelMesh.vertices[vertexID];
+            unsigned long long int positionKey = (unsigned long long int)(unsigned short int)vertex.finalX
+                | ((unsigned long long int)(unsigned short int)vertex.finalY << 16)
+                | ((unsigned long long int)(unsigned short int)vertex.finalZ << 32);
+            auto [positionIndex, newPosition] = positionIndices.emplace(positionKey, (int)positionIndices.size());
+            if (newPosition)
+                weldedCorners.positions.insert(weldedCorners.positions.end(), { vertex.finalX, vertex.finalY, vertex.finalZ });
+
+            unsigned int u, v;
+            std::memcpy(&u, &modelMesh.UVs[c].u, sizeof(u));
+            std::memcpy(&v, &modelMesh.UVs[c].v, sizeof(v));
+            auto [UVIndex, newUV] = UVIndices.emplace(((unsigned long long int)u << 32) | v, (int)UVIndices.size());
+            if (newUV)
+                weldedCorners.UVs.insert(weldedCorners.UVs.end(), { modelMesh.UVs[c].u, modelMesh.UVs[c].v });
+
+            weldedCorners.cornerIndices.push_back(positionIndex->second);
+            weldedCorners.cornerIndices.push_back(UVIndex->second);
+            c++;
+        }
+    }
+
+    return weldedCorners;
+}
+
+int exportPositions(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, int materialID)
+{
+    outputDAE.openElement("source");
+    outputDAE.attribute("id", std::format("meshId{}-positions", materialID));
+    outputDAE.attribute("name", std::format("meshId{}-positions", materialID));
+    outputDAE.openElement("float_array");
+    outputDAE.attribute("id", std::format("meshId{}-positions-array", materialID));
+    outputDAE.attribute("count", weldedCorners.positions.size());
+    outputDAE.text(" ");
+    for (size_t p = 0; p < weldedCorners.positions.size(); p += 3)
+    {
+        // Positions are in thousandths, written out as fixed point so they don't pick up float rounding errors
+        char* positionsText = outputDAE.beginTextInPlace(3 * (maxFormattedNumberLength + 1));
+        outputDAE.endTextInPlace(formatFixedPoints(positionsText, &weldedCorners.positions[p], 3, 3));
+    }
+    outputDAE.closeElement();
+    outputDAE.openElement("technique_common");
+    outputDAE.openElement("accessor");
+    outputDAE.attribute("count", weldedCorners.positions.size() / 3);
+    outputDAE.attribute("offset", 0);
+    outputDAE.attribute("source", std::format("#meshId{}-positions-array", materialID));
+    outputDAE.attribute("stride", 3);
+    exportAccessorParams(outputDAE, { "X", "Y", "Z" });
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportTextures(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, std::vector<PolygonStruct>& meshPolygons, int materialID)
+int exportTextures(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, int materialID)
 {
-    tinyxml2::XMLElement* texturesSource = outputDAE.NewElement("source");
-    texturesSource->SetAttribute("id", std::format("meshId{}-tex", materialID).c_str());
-    texturesSource->SetAttribute("name", std::format("meshId{}-tex", materialID).c_str());
-    tinyxml2::XMLElement* texturesFloat_array = outputDAE.NewElement("float_array");
-    texturesFloat_array->SetAttribute("id", std::format("meshId{}-tex-array", materialID).c_str());
-    texturesFloat_array->SetAttribute("count", meshPolygons.size() * 6);
-    std::string texturesString = " ";
-    for (int p = 0; p < meshPolygons.size(); p++)
+    outputDAE.openElement("source");
+    outputDAE.attribute("id", std::format("meshId{}-tex", materialID));
+    outputDAE.attribute("name", std::format("meshId{}-tex", materialID));
+    outputDAE.openElement("float_array");
+    outputDAE.attribute("id", std::format("meshId{}-tex-array", materialID));
+    outputDAE.attribute("count", weldedCorners.UVs.size());
+    outputDAE.text(" ");
+    for (size_t u = 0; u < weldedCorners.UVs.size(); u += 2)
     {
-        texturesString += std::format("{} ", meshPolygons[p].uv1.u);
-        texturesString += std::format("{} ", meshPolygons[p].uv1.v);
-        texturesString += std::format("{} ", meshPolygons[p].uv2.u);
-        texturesString += std::format("{} ", meshPolygons[p].uv2.v);
-        texturesString += std::format("{} ", meshPolygons[p].uv3.u);
-        texturesString += std::format("{} ", meshPolygons[p].uv3.v);
+        char* UVsText = outputDAE.beginTextInPlace(2 * (maxFormattedNumberLength + 1));
+        outputDAE.endTextInPlace(formatFloats(UVsText, &weldedCorners.UVs[u], 2));
     }
-    texturesFloat_array->SetText(texturesString.c_str());
-    tinyxml2::XMLElement* texturesTechnique_common = outputDAE.NewElement("technique_common");
-    tinyxml2::XMLElement* texturesAccessor = outputDAE.NewElement("accessor");
-    texturesAccessor->SetAttribute("count", meshPolygons.size() * 3);
-    texturesAccessor->SetAttribute("offset", 0);
-    texturesAccessor->SetAttribute("source", std::format("#meshId{}-tex-array", materialID).c_str());
-    texturesAccessor->SetAttribute("stride", 2);
-    tinyxml2::XMLElement* paramS = outputDAE.NewElement("param");
-    paramS->SetAttribute("name", "S");
-    paramS->SetAttribute("type", "float");
-    tinyxml2::XMLElement* paramT = outputDAE.NewElement("param");
-    paramT->SetAttribute("name", "T");
-    paramT->SetAttribute("type", "float");
-
-    texturesAccessor->LinkEndChild(paramS);
-    texturesAccessor->LinkEndChild(paramT);
-    texturesTechnique_common->LinkEndChild(texturesAccessor);
-    texturesSource->LinkEndChild(texturesFloat_array);
-    texturesSource->LinkEndChild(texturesTechnique_common);
-    mesh->LinkEndChild(texturesSource);
+    outputDAE.closeElement();
+    outputDAE.openElement("technique_common");
+    outputDAE.openElement("accessor");
+    outputDAE.attribute("count", weldedCorners.UVs.size() / 2);
+    outputDAE.attribute("offset", 0);
+    outputDAE.attribute("source", std::format("#meshId{}-tex-array", materialID));
+    outputDAE.attribute("stride", 2);
+    exportAccessorParams(outputDAE, { "S", "T" });
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportColours(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, std::vector<PolygonStruct>& meshPolygons, Material exportMaterial, int materialID)
+int exportColours(XMLWriter& outputDAE, Material exportMaterial, int materialID)
 {
-    tinyxml2::XMLElement* coloursSource = outputDAE.NewElement("source");
-    coloursSource->SetAttribute("id", std::format("meshId{}-color", materialID).c_str());
-    coloursSource->SetAttribute("name", std::format("meshId{}-color", materialID).c_str());
-    tinyxml2::XMLElement* coloursFloat_array = outputDAE.NewElement("float_array");
-    coloursFloat_array->SetAttribute("id", std::format("meshId{}-colors-array", materialID).c_str());
-    coloursFloat_array->SetAttribute("count", meshPolygons.size() * 9);
-    std::string coloursString = " ";
-    for (int c = 0; c < meshPolygons.size() * 3; c++)
+    outputDAE.openElement("source");
+    outputDAE.attribute("id", std::format("meshId{}-color", materialID));
+    outputDAE.attribute("name", std::format("meshId{}-color", materialID));
+    outputDAE.openElement("float_array");
+    outputDAE.attribute("id", std::format("meshId{}-colors-array", materialID));
+    outputDAE.attribute("count", 3);
+
+    // Every corner has the material's colour, so it's the only one
+    char colourText[3 * (maxFormattedNumberLength + 1) + 1] = " 0 0 0 ";
+    char* colourTextEnd = colourText + 7;
+    if (exportMaterial.realMaterial)
     {
-        if (exportMaterial.realMaterial)
+        colourTextEnd = colourText + 1;
+        for (unsigned char colour : { exportMaterial.redVal, exportMaterial.greenVal, exportMaterial.blueVal })
         {
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.redVal) / 1.25f) + " ";
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.greenVal) / 1.25f) + " ";
-            coloursString += std::to_string(rgbToLinearRgb(exportMaterial.blueVal) / 1.25f) + " ";
+            colourTextEnd = formatFloatFixed(colourTextEnd, rgbToLinearRgb(colour) / 1.25f);
+            *colourTextEnd++ = ' ';
         }
-        else
-            coloursString += "0 0 0 ";
     }
-    coloursFloat_array->SetText(coloursString.c_str());
-    tinyxml2::XMLElement* coloursTechnique_common = outputDAE.NewElement("technique_common");
-    tinyxml2::XMLElement* coloursAccessor = outputDAE.NewElement("accessor");
-    coloursAccessor->SetAttribute("count", meshPolygons.size() * 3);
-    coloursAccessor->SetAttribute("offset", 0);
-    coloursAccessor->SetAttribute("source", std::format("#meshId{}-color-array", materialID).c_str());
-    coloursAccessor->SetAttribute("stride", 3);
-    tinyxml2::XMLElement* paramR = outputDAE.NewElement("param");
-    paramR->SetAttribute("name", "R");
-    paramR->SetAttribute("type", "float");
-    tinyxml2::XMLElement* paramG = outputDAE.NewElement("param");
-    paramG->SetAttribute("name", "G");
-    paramG->SetAttribute("type", "float");
-    tinyxml2::XMLElement* paramB = outputDAE.NewElement("param");
-    paramB->SetAttribute("name", "B");
-    paramB->SetAttribute("type", "float");
-
-    coloursAccessor->LinkEndChild(paramR);
-    coloursAccessor->LinkEndChild(paramG);
-    coloursAccessor->LinkEndChild(paramB);
-    coloursTechnique_common->LinkEndChild(coloursAccessor);
-    coloursSource->LinkEndChild(coloursFloat_array);
-    coloursSource->LinkEndChild(coloursTechnique_common);
-    mesh->LinkEndChild(coloursSource);
+    outputDAE.text(std::string_view(colourText, colourTextEnd - colourText));
+    outputDAE.closeElement();
+    outputDAE.openElement("technique_common");
+    outputDAE.openElement("accessor");
+    outputDAE.attribute("count", 1);
+    outputDAE.attribute("offset", 0);
+    outputDAE.attribute("source", std::format("#meshId{}-colors-array", materialID));
+    outputDAE.attribute("stride", 3);
+    exportAccessorParams(outputDAE, { "R", "G", "B" });
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportVertices(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, int materialID)
+int exportVertices(XMLWriter& outputDAE, int materialID)
 {
-    tinyxml2::XMLElement* xVertices = outputDAE.NewElement("vertices");
-    xVertices->SetAttribute("id", std::format("meshId{}-vertices", materialID).c_str());
-    tinyxml2::XMLElement* input = outputDAE.NewElement("input");
-    input->SetAttribute("semantic", "POSITION");
-    input->SetAttribute("source", std::format("#meshId{}-positions", materialID).c_str());
-    xVertices->LinkEndChild(input);
-    mesh->LinkEndChild(xVertices);
+    outputDAE.openElement("vertices");
+    outputDAE.attribute("id", std::format("meshId{}-vertices", materialID));
+    outputDAE.openElement("input");
+    outputDAE.attribute("semantic", "POSITION");
+    outputDAE.attribute("source", std::format("#meshId{}-positions", materialID));
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportPolygons(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* mesh, unsigned int meshPolygonsSize, int materialID)
+int exportPolygons(XMLWriter& outputDAE, const WeldedCorners& weldedCorners, unsigned int meshPolygonsSize, int materialID)
 {
-    tinyxml2::XMLElement* polylist = outputDAE.NewElement("polylist");
-    polylist->SetAttribute("count", meshPolygonsSize);
-    polylist->SetAttribute("material", "defaultMaterial");
-    tinyxml2::XMLElement* inputVertex = outputDAE.NewElement("input");
-    inputVertex->SetAttribute("offset", 0);
-    inputVertex->SetAttribute("semantic", "VERTEX");
-    inputVertex->SetAttribute("source", std::format("#meshId{}-vertices", materialID).c_str());
-    tinyxml2::XMLElement* inputTexCoord = outputDAE.NewElement("input");
-    inputTexCoord->SetAttribute("offset", 0);
-    inputTexCoord->SetAttribute("semantic", "TEXCOORD");
-    inputTexCoord->SetAttribute("source", std::format("#meshId{}-tex", materialID).c_str());
-    inputTexCoord->SetAttribute("set", 0);
-    tinyxml2::XMLElement* inputColour = outputDAE.NewElement("input");
-    inputColour->SetAttribute("offset", 0);
-    inputColour->SetAttribute("semantic", "COLOR");
-    inputColour->SetAttribute("source", std::format("#meshId{}-color", materialID).c_str());
-    inputColour->SetAttribute("set", 0);
-    tinyxml2::XMLElement* vCount = outputDAE.NewElement("vcount");
-    tinyxml2::XMLElement* pPolylist = outputDAE.NewElement("p");
-    std::string vCountString = "";
-    std::string polyString = "";
-    for (unsigned int p = 0; p < meshPolygonsSize; p++)
+    outputDAE.openElement("triangles");
+    outputDAE.attribute("count", meshPolygonsSize);
+    outputDAE.attribute("material", "defaultMaterial");
+    outputDAE.openElement("input");
+    outputDAE.attribute("offset", 0);
+    outputDAE.attribute("semantic", "VERTEX");
+    outputDAE.attribute("source", std::format("#meshId{}-vertices", materialID));
+    outputDAE.closeElement();
+    outputDAE.openElement("input");
+    outputDAE.attribute("offset", 1);
+    outputDAE.attribute("semantic", "TEXCOORD");
+    outputDAE.attribute("source", std::format("#meshId{}-tex", materialID));
+    outputDAE.attribute("set", 0);
+    outputDAE.closeElement();
+    outputDAE.openElement("input");
+    outputDAE.attribute("offset", 2);
+    outputDAE.attribute("semantic", "COLOR");
+    outputDAE.attribute("source", std::format("#meshId{}-color", materialID));
+    outputDAE.attribute("set", 0);
+    outputDAE.closeElement();
+
+    // Each corner is its position index, its UV index, and the colour's index, which is always 0
+    outputDAE.openElement("p");
+    outputDAE.text("");
+    for (size_t c = 0; c < weldedCorners.cornerIndices.size(); c += 2)
     {
-        vCountString += "3 ";
-        polyString += std::format("{} {} {} ", (p * 3), (p * 3) + 1, (p * 3) + 2);
+        char* cornerText = outputDAE.beginTextInPlace(2 * (maxFormattedNumberLength + 1) + 2);
+        cornerText = formatIntegers(cornerText, &weldedCorners.cornerIndices[c], 2);
+        *cornerText++ = '0';
+        *cornerText++ = ' ';
+        outputDAE.endTextInPlace(cornerText);
     }
-    vCount->SetText(vCountString.c_str());
-    pPolylist->SetText(polyString.c_str());
+    outputDAE.closeElement();
 
-    polylist->LinkEndChild(inputVertex);
-    polylist->LinkEndChild(inputTexCoord);
-    polylist->LinkEndChild(inputColour);
-    polylist->LinkEndChild(vCount);
-    polylist->LinkEndChild(pPolylist);
-    mesh->LinkEndChild(polylist);
+    outputDAE.closeElement();
 
     return 0;
 }
 
-int exportVisualScene(tinyxml2::XMLDocument& outputDAE, tinyxml2::XMLElement* nodeModel, int materialID, std::string objectName)
+int exportVisualScene(XMLWriter& outputDAE, int materialID, std::string objectName)
 {
-    tinyxml2::XMLElement* instance_geometry = outputDAE.NewElement("instance_geometry");
-    instance_geometry->SetAttribute("url", std::format("#meshId{}", materialID).c_str());
-    tinyxml2::XMLElement* bind_material = outputDAE.NewElement("bind_material");
-    tinyxml2::XMLElement* visualSceneTechnique_common = outputDAE.NewElement("technique_common");
-    tinyxml2::XMLElement* instance_material = outputDAE.NewElement("instance_material");
-    instance_material->SetAttribute("symbol", "defaultMaterial");
-    instance_material->SetAttribute("target", std::format("#{}-mat{}", objectName, materialID).c_str());
-    tinyxml2::XMLElement* bind_vertex_input = outputDAE.NewElement("bind_vertex_input");
-    bind_vertex_input->SetAttribute("semantic", "CHANNEL0");
-    bind_vertex_input->SetAttribute("input_semantic", "TEXCOORD");
-    bind_vertex_input->SetAttribute("input_set", 0);
-
-    instance_material->LinkEndChild(bind_vertex_input);
-    visualSceneTechnique_common->LinkEndChild(instance_material);
-    bind_material->LinkEndChild(visualSceneTechnique_common);
-    instance_geometry->LinkEndChild(bind_material);
-    nodeModel->LinkEndChild(instance_geometry);
+    outputDAE.openElement("instance_geometry");
+    outputDAE.attribute("url", std::format("#meshId{}", materialID));
+    outputDAE.openElement("bind_material");
+    outputDAE.openElement("technique_common");
+    outputDAE.openElement("instance_material");
+    outputDAE.attribute("symbol", "defaultMaterial");
+    outputDAE.attribute("target", std::format("#{}-mat{}", objectName, materialID));
+    outputDAE.openElement("bind_vertex_input");
+    outputDAE.attribute("semantic", "CHANNEL0");
+    outputDAE.attribute("input_semantic", "TEXCOORD");
+    outputDAE.attribute("input_set", 0);
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
+    outputDAE.closeElement();
 
     return 0;
-}
\ No newline at end of file
+}
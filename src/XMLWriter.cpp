@@ -0,0 +1,171 @@
+/*  Gex2PS1ModelExporter: Command line program for exporting Gex 2 PS1 models
+    Copyright (C) 2023  Roboguy420
+
+    Gex2PS1ModelExporter is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Gex2PS1ModelExporter is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gex2PS1ModelExporter.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#include "XMLWriter.h"
+
+#include <charconv>
+
+bool XMLWriter::open(std::string path)
+{
+	return file.open(path);
+}
+
+bool XMLWriter::close()
+{
+	return file.close();
+}
+
+void XMLWriter::declaration(std::string_view value)
+{
+	sealElement();
+	if (firstNode)
+		file.write(openElements.size() * 4, ' ');
+	else if (textDepth < 0)
+		newLine();
+	firstNode = false;
+
+	file.write("<?");
+	file.write(value);
+	file.write("?>");
+}
+
+void XMLWriter::openElement(const char* name)
+{
+	sealElement();
+	if (textDepth < 0 && !firstNode)
+		newLine();
+	firstNode = false;
+
+	file.write('<');
+	file.write(name);
+	openElements.push_back(name);
+	elementJustOpened = true;
+}
+
+void XMLWriter::attribute(const char* name, std::string_view value)
+{
+	file.write(' ');
+	file.write(name);
+	file.write("=\"");
+	writeEscaped(value, true);
+	file.write('"');
+}
+
+void XMLWriter::attribute(const char* name, long long int value)
+{
+	file.write(' ');
+	file.write(name);
+	file.write("=\"");
+	char* valueText = file.beginInPlace(20);
+	file.endInPlace(std::to_chars(valueText, valueText + 20, value).ptr);
+	file.write('"');
+}
+
+void XMLWriter::closeElement()
+{
+	const char* name = openElements.back();
+	openElements.pop_back();
+
+	if (elementJustOpened)
+		file.write("/>");
+	else
+	{
+		if (textDepth < 0)
+			newLine();
+		file.write("</");
+		file.write(name);
+		file.write('>');
+	}
+
+	if (textDepth == (int)openElements.size())
+		textDepth = -1;
+	if (openElements.empty())
+		file.write('\n');
+	elementJustOpened = false;
+}
+
+void XMLWriter::text(std::string_view text)
+{
+	beginText();
+	writeEscaped(text, false);
+}
+
+char* XMLWriter::beginTextInPlace(size_t maxLength)
+{
+	beginText();
+	return file.beginInPlace(maxLength);
+}
+
+void XMLWriter::endTextInPlace(char* end)
+{
+	file.endInPlace(end);
+}
+
+void XMLWriter::textElement(const char* name, std::string_view text)
+{
+	openElement(name);
+	this->text(text);
+	closeElement();
+}
+
+void XMLWriter::beginText()
+{
+	textDepth = openElements.size() - 1;
+	sealElement();
+}
+
+void XMLWriter::sealElement()
+{
+	if (elementJustOpened)
+	{
+		file.write('>');
+		elementJustOpened = false;
+	}
+}
+
+void XMLWriter::newLine()
+{
+	file.write('\n');
+	file.write(openElements.size() * 4, ' ');
+}
+
+// Text only needs &, < and > escaped, attributes need quotes escaped too
+void XMLWriter::writeEscaped(std::string_view text, bool isAttribute)
+{
+	for (char character : text)
+	{
+		switch (character)
+		{
+		case '&':
+			file.write("&amp;");
+			break;
+		case '<':
+			file.write("&lt;");
+			break;
+		case '>':
+			file.write("&gt;");
+			break;
+		case '"':
+			file.write(isAttribute ? "&quot;" : "\"");
+			break;
+		case '\'':
+			file.write(isAttribute ? "&apos;" : "'");
+			break;
+		default:
+			file.write(character);
+		}
+	}
+}